@@ -0,0 +1,368 @@
+#include "bench_utils.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <vector>
+
+#if defined(__linux__)
+#    include <linux/perf_event.h>
+#    include <sys/ioctl.h>
+#    include <sys/syscall.h>
+#    include <unistd.h>
+#    define DAISY_HAS_PERF_EVENTS 1
+#endif
+
+namespace lex_detail {
+#include "lex_defs.h"
+#include "lex_analyzer.inl"
+}  // namespace lex_detail
+
+namespace parser_detail {
+#include "parser_defs.h"
+#include "parser_analyzer.inl"
+}  // namespace parser_detail
+
+#include "keywords.h"
+
+// Compares lexical analyzer and parser driven by narrowed tables as they are generated with the same tables widened
+// to `int`, on a large synthetic source. Cache misses are counted with hardware performance counters where they are
+// available (Linux `perf_event_open`)
+
+namespace {
+
+using namespace daisy::bench;
+
+template<typename Ty>
+using TableSpan = std::span<const std::remove_extent_t<Ty>>;
+
+template<typename Ty, std::size_t N>
+std::vector<int> widen(const Ty (&table)[N]) {
+    return std::vector<int>(table, table + N);
+}
+
+struct NarrowTables {
+    TableSpan<decltype(lex_detail::def)> def{lex_detail::def};
+    TableSpan<decltype(lex_detail::base)> base{lex_detail::base};
+    TableSpan<decltype(lex_detail::next)> next{lex_detail::next};
+    TableSpan<decltype(lex_detail::check)> check{lex_detail::check};
+    TableSpan<decltype(lex_detail::accept)> accept{lex_detail::accept};
+    TableSpan<decltype(parser_detail::action_idx)> action_idx{parser_detail::action_idx};
+    TableSpan<decltype(parser_detail::action_list)> action_list{parser_detail::action_list};
+    TableSpan<decltype(parser_detail::reduce_info)> reduce_info{parser_detail::reduce_info};
+    TableSpan<decltype(parser_detail::goto_list)> goto_list{parser_detail::goto_list};
+};
+
+struct WideTables {
+    std::vector<int> def = widen(lex_detail::def);
+    std::vector<int> base = widen(lex_detail::base);
+    std::vector<int> next = widen(lex_detail::next);
+    std::vector<int> check = widen(lex_detail::check);
+    std::vector<int> accept = widen(lex_detail::accept);
+    std::vector<int> action_idx = widen(parser_detail::action_idx);
+    std::vector<int> action_list = widen(parser_detail::action_list);
+    std::vector<int> reduce_info = widen(parser_detail::reduce_info);
+    std::vector<int> goto_list = widen(parser_detail::goto_list);
+};
+
+template<typename Tables>
+std::size_t getTableBytes(const Tables& t) {
+    auto bytes = [](const auto& table) { return table.size() * sizeof(table[0]); };
+    return bytes(t.def) + bytes(t.base) + bytes(t.next) + bytes(t.check) + bytes(t.accept) + bytes(t.action_idx) +
+           bytes(t.action_list) + bytes(t.reduce_info) + bytes(t.goto_list);
+}
+
+// Note: these follow `lex_detail::lex` and `parser_detail::parse` for input without errors
+
+template<typename Tables>
+int lexLexeme(const Tables& t, const char* first, const char* last, int* sptr, std::size_t& llen) {
+    int* sptr0 = sptr;
+    int state = lex_detail::sc_initial << 1;
+    while (first != last) {
+        const std::uint8_t meta = lex_detail::symb2meta[static_cast<unsigned char>(*first)];
+        do {
+            const int l = t.base[state] + meta;
+            if (t.check[l] == state) {
+                state = t.next[l];
+                break;
+            }
+            state = t.def[state];
+        } while (state >= 0);
+        if (state < 0) { break; }
+        *sptr++ = state, ++first;
+    }
+    for (; sptr != sptr0; --sptr) {
+        if (const int pat = t.accept[*(sptr - 1)]; pat > 0) {
+            llen = static_cast<std::size_t>(sptr - sptr0);
+            return pat;
+        }
+    }
+    llen = 1;
+    return lex_detail::predef_pat_default;
+}
+
+template<typename Tables>
+int parseToken(const Tables& t, int tt, int*& sptr) {
+    const auto* action_tbl = &t.action_list[t.action_idx[*(sptr - 1)]];
+    while (action_tbl[0] >= 0 && action_tbl[0] != tt) { action_tbl += 2; }
+    const int action = action_tbl[1];
+    if (action < 0) { return action; }
+    if (!(action & 1)) {
+        const auto* info = &t.reduce_info[action >> 1];
+        const auto* goto_tbl = &t.goto_list[info[1]];
+        const int state = *((sptr -= info[0]) - 1);
+        while (goto_tbl[0] >= 0 && goto_tbl[0] != state) { goto_tbl += 2; }
+        *sptr++ = goto_tbl[1];
+        return parser_detail::predef_act_reduce + info[2];
+    }
+    *sptr++ = action >> 1;
+    return parser_detail::predef_act_shift;
+}
+
+constexpr util::keyword_table g_keywords(daisy::kKeywords);
+
+// Returns the token type of the lexeme or 0 if the lexeme is skipped
+int getTokenType(int pat, std::string_view lexeme) {
+    switch (pat) {
+        case lex_detail::pat_shl: return parser_detail::tt_shl;
+        case lex_detail::pat_shr: return parser_detail::tt_shr;
+        case lex_detail::pat_eq: return parser_detail::tt_eq;
+        case lex_detail::pat_ne: return parser_detail::tt_ne;
+        case lex_detail::pat_le: return parser_detail::tt_le;
+        case lex_detail::pat_ge: return parser_detail::tt_ge;
+        case lex_detail::pat_and: return parser_detail::tt_and;
+        case lex_detail::pat_or: return parser_detail::tt_or;
+        case lex_detail::pat_arrow: return parser_detail::tt_arrow;
+        case lex_detail::pat_true_literal:
+        case lex_detail::pat_false_literal: return parser_detail::tt_bool_literal;
+        case lex_detail::pat_bin_literal:
+        case lex_detail::pat_oct_literal:
+        case lex_detail::pat_dec_literal:
+        case lex_detail::pat_hex_literal: return parser_detail::tt_int_literal;
+        case lex_detail::pat_float_literal: return parser_detail::tt_float_literal;
+        case lex_detail::pat_id: {
+            const int tt = g_keywords.find(lexeme);
+            return tt ? tt : parser_detail::tt_id;
+        } break;
+        case lex_detail::pat_scope_resolution: return parser_detail::tt_scope_resolution;
+        case lex_detail::pat_whitespace:
+        case lex_detail::pat_nl: return 0;
+        default: break;
+    }
+    return static_cast<unsigned char>(lexeme[0]);
+}
+
+std::string makeCorpus(std::size_t size) {
+    return repeatLines(size, [](unsigned n) {
+        const std::string k = std::to_string(n);
+        return "func f" + k + "(x: i32, mut y: i32, z: ::std::f64) -> i32 {\n" +
+                "    let mut a = x + y * 3 - (x << 2), b: i64 = f" + k + "(a, 0x1f, z / 2.5e1) % 7;\n" +
+                "    if a > 0 && b != 1 || !(a <= 3) { a = a + 1; } else { b = -b; };\n" +
+                "    while a < 100 { a = a * 2 + 0b101; };\n" +
+                "    const k" + k + " = true;\n" +
+                "    a ? b : ~x | y ^ 3 & a >> 1\n" +
+                "}\n";
+    });
+}
+
+enum class Cache { kL1d = 0, kLastLevel };
+
+#if defined(DAISY_HAS_PERF_EVENTS)
+class CacheMissCounter {
+ public:
+    explicit CacheMissCounter(Cache cache) {
+        perf_event_attr attr{};
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.size = sizeof(attr);
+        attr.config = (cache == Cache::kL1d ? PERF_COUNT_HW_CACHE_L1D : PERF_COUNT_HW_CACHE_LL) |
+                      (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~CacheMissCounter() {
+        if (fd_ >= 0) { close(fd_); }
+    }
+    CacheMissCounter(const CacheMissCounter&) = delete;
+    CacheMissCounter& operator=(const CacheMissCounter&) = delete;
+
+    bool isAvailable() const { return fd_ >= 0; }
+    void start() {
+        if (fd_ >= 0) { ioctl(fd_, PERF_EVENT_IOC_RESET, 0), ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0); }
+    }
+    std::uint64_t stop() {
+        std::uint64_t count = 0;
+        if (fd_ >= 0) {
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            if (read(fd_, &count, sizeof(count)) != sizeof(count)) { count = 0; }
+        }
+        return count;
+    }
+
+ private:
+    int fd_ = -1;
+};
+#else   // defined(DAISY_HAS_PERF_EVENTS)
+class CacheMissCounter {
+ public:
+    explicit CacheMissCounter(Cache) {}
+    bool isAvailable() const { return false; }
+    void start() {}
+    std::uint64_t stop() { return 0; }
+};
+#endif  // defined(DAISY_HAS_PERF_EVENTS)
+
+struct Stats {
+    double rate = 0;  // of bytes for the lexer and of reductions for the parser, per second
+    double l1d_misses = 0, llc_misses = 0;
+};
+
+struct Result {
+    std::size_t token_count = 0, reduce_count = 0;
+    unsigned checksum = 0;
+    Stats lexer, parser;
+};
+
+template<typename Tables>
+bool measure(const Tables& t, const std::string& text, unsigned iterations, Result& result) {
+    CacheMissCounter l1d(Cache::kL1d), llc(Cache::kLastLevel);
+    std::vector<int> tokens, state_stack(256);
+    std::vector<int> parser_stack(4096);
+    tokens.reserve(text.size() / 2);
+
+    // Note: lexemes of the corpus are short, so the state stack of the lexer never overflows
+    double elapsed = 0;
+    std::uint64_t l1d_misses = 0, llc_misses = 0;
+    for (unsigned i = 0; i < iterations; ++i) {
+        tokens.clear();
+        elapsed += measureSeconds([&] {
+            l1d.start(), llc.start();
+            for (const char *first = text.data(), *last = first + text.size(); first != last;) {
+                std::size_t llen = 0;
+                const int pat = lexLexeme(t, first, std::min(last, first + state_stack.size()), state_stack.data(),
+                                          llen);
+                if (int tt = getTokenType(pat, std::string_view(first, llen))) { tokens.push_back(tt); }
+                first += llen;
+            }
+            l1d_misses += l1d.stop(), llc_misses += llc.stop();
+        });
+    }
+    tokens.push_back(parser_detail::tt_end_of_file);
+    result.token_count = tokens.size();
+    result.lexer.rate = static_cast<double>(text.size()) * iterations / elapsed;
+    result.lexer.l1d_misses = static_cast<double>(l1d_misses) / (static_cast<double>(tokens.size()) * iterations);
+    result.lexer.llc_misses = static_cast<double>(llc_misses) / (static_cast<double>(tokens.size()) * iterations);
+
+    elapsed = 0, l1d_misses = 0, llc_misses = 0;
+    for (unsigned i = 0; i < iterations; ++i) {
+        std::size_t reduce_count = 0;
+        unsigned checksum = 0;
+        bool is_parsed = true;
+        int* sptr = parser_stack.data();
+        *sptr++ = parser_detail::sc_initial;
+        elapsed += measureSeconds([&] {
+            l1d.start(), llc.start();
+            for (const int* tt = tokens.data(); true;) {
+                const int act = parseToken(t, *tt, sptr);
+                if (act < 0 || sptr - parser_stack.data() == static_cast<std::ptrdiff_t>(parser_stack.size())) {
+                    is_parsed = false;
+                    break;
+                }
+                if (act != parser_detail::predef_act_shift) {
+                    ++reduce_count, checksum += static_cast<unsigned>(act);
+                } else if (*tt++ == parser_detail::tt_end_of_file) {
+                    break;
+                }
+            }
+            l1d_misses += l1d.stop(), llc_misses += llc.stop();
+        });
+        if (!is_parsed) { return false; }
+        result.reduce_count = reduce_count, result.checksum = checksum;
+    }
+    result.parser.rate = static_cast<double>(result.reduce_count) * iterations / elapsed;
+    result.parser.l1d_misses = static_cast<double>(l1d_misses) /
+                               (static_cast<double>(result.reduce_count) * iterations);
+    result.parser.llc_misses = static_cast<double>(llc_misses) /
+                               (static_cast<double>(result.reduce_count) * iterations);
+    return true;
+}
+
+// Analyzes the corpus once with generated `lex_detail::lex` and `parser_detail::parse` to validate the results
+bool analyzeReference(const std::string& text, Result& result) {
+    std::vector<int> tokens, state_stack(256), parser_stack(4096);
+    for (const char *first = text.data(), *last = first + text.size(); first != last;) {
+        int* sptr = state_stack.data();
+        *sptr++ = lex_detail::sc_initial;
+        std::size_t llen = 0;
+        const int pat = lex_detail::lex(first, last, &sptr, &llen, 0);
+        if (pat < 0) { return false; }
+        if (int tt = getTokenType(pat, std::string_view(first, llen))) { tokens.push_back(tt); }
+        first += llen;
+    }
+    tokens.push_back(parser_detail::tt_end_of_file);
+
+    int* sptr = parser_stack.data();
+    *sptr++ = parser_detail::sc_initial;
+    for (const int* tt = tokens.data(); true;) {
+        const int act = parser_detail::parse(*tt, parser_stack.data(), &sptr, 0);
+        if (act < 0) { return false; }
+        if (act != parser_detail::predef_act_shift) {
+            ++result.reduce_count, result.checksum += static_cast<unsigned>(act);
+        } else if (*tt++ == parser_detail::tt_end_of_file) {
+            break;
+        }
+    }
+    result.token_count = tokens.size();
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    unsigned iterations = 10;
+    if (argc > 1 && (!parseArgument(argv[1], iterations) || iterations == 0)) {
+        uxs::println(uxs::stdbuf::log(), "invalid command line argument `{}`", argv[1]);
+        return 1;
+    }
+    const std::string text = makeCorpus(16 << 20);
+    const bool has_counters = CacheMissCounter(Cache::kL1d).isAvailable();
+
+    const NarrowTables narrow_tables;
+    const WideTables wide_tables;
+    Result reference, narrow, wide;
+    if (!analyzeReference(text, reference) || !measure(wide_tables, text, iterations, wide) ||
+        !measure(narrow_tables, text, iterations, narrow)) {
+        uxs::println(uxs::stdbuf::log(), "failed to parse corpus");
+        return 1;
+    }
+    const auto is_same = [&reference](const Result& result) {
+        return result.token_count == reference.token_count && result.reduce_count == reference.reduce_count &&
+               result.checksum == reference.checksum;
+    };
+    if (!is_same(narrow) || !is_same(wide)) {
+        uxs::println(uxs::stdbuf::log(), "analysis results differ");
+        return 1;
+    }
+
+    uxs::println(uxs::stdbuf::out(), "{} bytes, {} tokens, {} reductions", text.size(), narrow.token_count,
+                 narrow.reduce_count);
+    for (const auto& [name, bytes, result] : {std::tuple{"int", getTableBytes(wide_tables), wide},
+                                               std::tuple{"narrow", getTableBytes(narrow_tables), narrow}}) {
+        uxs::println(uxs::stdbuf::out(), "{} tables ({} bytes): lexer {:.1f} MB/s, parser {:.1f} M reductions/s", name,
+                     bytes, result.lexer.rate / (1024 * 1024), result.parser.rate / 1e6);
+        if (has_counters) {
+            uxs::println(uxs::stdbuf::out(), "  L1D misses: {:.4f} per token, {:.4f} per reduction",
+                         result.lexer.l1d_misses, result.parser.l1d_misses);
+            uxs::println(uxs::stdbuf::out(), "  LLC misses: {:.4f} per token, {:.4f} per reduction",
+                         result.lexer.llc_misses, result.parser.llc_misses);
+        }
+    }
+    if (!has_counters) { uxs::println(uxs::stdbuf::out(), "cache miss counters are not available"); }
+    return 0;
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include "uxs/io/filebuf.h"
+
+#include <uxs/format.h>
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cstdlib>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+// Helpers shared by benchmarks: timing, corpus generation, argument parsing and JSON output of results
+
+namespace daisy::bench {
+
+// Returns duration of the call in seconds
+template<typename Func>
+double measureSeconds(Func&& func) {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count();
+}
+
+inline double median(std::vector<double> samples) {
+    const auto mid = samples.begin() + samples.size() / 2;
+    std::nth_element(samples.begin(), mid, samples.end());
+    return *mid;
+}
+
+// Concatenates `func(n)` for n = 0, 1, ... until the text is at least `size` bytes long
+template<typename Func>
+std::string repeatLines(std::size_t size, Func func) {
+    std::string text;
+    for (unsigned n = 0; text.size() < size; ++n) { text += func(n); }
+    return text;
+}
+
+// A declaration with identifiers and operators, as most lines of sources are
+inline std::string makeIdentifierLine(unsigned n) {
+    const std::string k = std::to_string(n % 97);
+    return "let next_node_" + k + " = value_" + k + " + buffer_size * count_" + k + ";\n";
+}
+
+inline bool readFile(const std::string& file_name, std::string& text) {
+    uxs::filebuf ifile(file_name.c_str(), "r");
+    if (!ifile) { return false; }
+    auto pos = ifile.seek(0, uxs::seekdir::end);
+    if (pos == uxs::iobuf::traits_type::npos()) { return false; }
+    text.resize(static_cast<std::size_t>(pos));
+    ifile.seek(0);
+    text.resize(ifile.read(std::span(text.data(), text.size())));
+    return true;
+}
+
+inline bool writeFile(const std::string& file_name, std::string_view text) {
+    uxs::filebuf ofile(file_name.c_str(), "w");
+    return ofile && ofile.write(text);
+}
+
+// Parses a whole command line argument as a number
+template<typename Ty>
+bool parseArgument(std::string_view arg, Ty& val) {
+    auto [p, ec] = std::from_chars(arg.data(), arg.data() + arg.size(), val);
+    return ec == std::errc() && p == arg.data() + arg.size() && !arg.empty();
+}
+
+// Builds a flat JSON object of results; strings are not escaped, they are plain names
+class JsonObject {
+ public:
+    template<typename Ty>
+    JsonObject& add(std::string_view name, const Ty& value) {
+        text_ += text_.empty() ? "{" : ", ";
+        if constexpr (std::is_convertible_v<const Ty&, std::string_view>) {
+            text_ += uxs::format("\"{}\": \"{}\"", name, std::string_view(value));
+        } else {
+            text_ += uxs::format("\"{}\": {}", name, value);
+        }
+        return *this;
+    }
+    JsonObject& addNull(std::string_view name) {
+        text_ += text_.empty() ? "{" : ", ";
+        text_ += uxs::format("\"{}\": null", name);
+        return *this;
+    }
+    std::string str() const { return text_.empty() ? "{}" : text_ + "}"; }
+
+ private:
+    std::string text_;
+};
+
+// Finds the number of `field` in the object with `"name": "<name>"` in JSON output of a previous run; returns `false`
+// if the object or the field is missing
+inline bool findBaseline(std::string_view json, std::string_view name, std::string_view field, double& value) {
+    const std::size_t pos = json.find(uxs::format("\"name\": \"{}\"", name));
+    if (pos == std::string_view::npos) { return false; }
+    const std::size_t field_pos = json.find(uxs::format("\"{}\": ", field), pos);
+    if (field_pos == std::string_view::npos || field_pos > json.find('}', pos)) { return false; }
+    const std::string number(json.substr(field_pos + field.size() + 4, 32));
+    char* end = nullptr;
+    value = std::strtod(number.c_str(), &end);
+    return end != number.c_str();
+}
+
+}  // namespace daisy::bench
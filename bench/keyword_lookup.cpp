@@ -0,0 +1,82 @@
+#include "bench_utils.h"
+
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace parser_detail {
+#include "parser_defs.h"
+}  // namespace parser_detail
+
+#include "keywords.h"
+
+// Compares keyword recognition of identifier tokens by `std::unordered_map` and by `util::keyword_table`
+
+namespace {
+
+using daisy::kKeywords;
+using namespace daisy::bench;
+
+constexpr util::keyword_table g_keyword_table(kKeywords);
+
+const std::unordered_map<std::string_view, int> g_keyword_map = [] {
+    std::unordered_map<std::string_view, int> map;
+    for (const auto& entry : kKeywords) { map.emplace(entry.word, entry.value); }
+    return map;
+}();
+
+// Identifiers similar to ones found in sources: about a quarter of them are keywords
+std::vector<std::string> makeIdentifiers(std::size_t count) {
+    static const char* const names[] = {"x", "i", "count", "result", "value", "next_node", "buffer", "size", "lhs",
+                                        "rhs", "make_struct", "loop_count", "get_value", "iffy", "constant"};
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<std::size_t> kind(0, 3), keyword(0, kKeywords.size() - 1),
+        name(0, std::size(names) - 1);
+    std::vector<std::string> ids;
+    ids.reserve(count);
+    for (std::size_t n = 0; n < count; ++n) {
+        ids.emplace_back(kind(gen) == 0 ? std::string(kKeywords[keyword(gen)].word) : std::string(names[name(gen)]));
+    }
+    return ids;
+}
+
+template<typename Func>
+double measure(const std::vector<std::string>& ids, unsigned iterations, long& checksum, Func func) {
+    const double elapsed = measureSeconds([&] {
+        for (unsigned i = 0; i < iterations; ++i) {
+            for (const auto& id : ids) { checksum += func(std::string_view(id)); }
+        }
+    });
+    return elapsed * 1e9 / (static_cast<double>(ids.size()) * iterations);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    unsigned iterations = 100;
+    if (argc > 1 && (!parseArgument(argv[1], iterations) || iterations == 0)) {
+        uxs::println(uxs::stdbuf::log(), "invalid command line argument `{}`", argv[1]);
+        return 1;
+    }
+    const auto ids = makeIdentifiers(100000);
+
+    long checksum_map = 0, checksum_table = 0;
+    const double map_time = measure(ids, iterations, checksum_map, [](std::string_view id) {
+        auto it = g_keyword_map.find(id);
+        return it != g_keyword_map.end() ? it->second : 0;
+    });
+    const double table_time = measure(ids, iterations, checksum_table,
+                                      [](std::string_view id) { return g_keyword_table.find(id); });
+
+    if (checksum_map != checksum_table) {
+        uxs::println(uxs::stdbuf::log(), "keyword lookup results differ");
+        return 1;
+    }
+
+    uxs::println(uxs::stdbuf::out(), "unordered_map: {:.2f} ns/lookup", map_time);
+    uxs::println(uxs::stdbuf::out(), "keyword_table: {:.2f} ns/lookup", table_time);
+    uxs::println(uxs::stdbuf::out(), "speedup: {:.2f}x", map_time / table_time);
+    return 0;
+}
@@ -0,0 +1,246 @@
+#include "bench_utils.h"
+#include "daisy_parser_pass.h"
+#include "pass_stats.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#    include <x86intrin.h>
+#    define DAISY_HAS_RDTSC 1
+#endif
+
+// Measures throughput of the lexical analyzer together with the preprocessor over synthetic corpora and prints
+// results as JSON. Usage:
+//   daisy-lex-bench [--iterations <n>] [--output <file>] [--baseline <file>] [--threshold <percent>]
+// Each corpus is lexed once cold, then `n` times by the analyzer with the lexeme cache turned off and `n` times by
+// replaying cached lexemes; steady-state figures are medians of these runs. With `--baseline` the results are compared
+// with previously saved output, and the exit code is nonzero if the median analyzer or replay throughput of any
+// corpus drops by more than the threshold (5% by default); a corpus missing from the baseline is an error
+
+namespace {
+
+using namespace daisy;
+using namespace daisy::bench;
+
+struct Corpus {
+    std::string name;
+    std::string group;  // "lexer" or "preproc"
+    std::string main_path;
+    std::size_t bytes = 0;  // of all lexed text, every inclusion counted
+};
+
+struct Result {
+    std::size_t tokens = 0;
+    double cold_mb_per_s = 0;    // the first run: files are loaded and lexed
+    double lex_mb_per_s = 0;     // the analyzer over loaded files
+    double replay_mb_per_s = 0;  // replay of cached lexemes
+    double tokens_per_s = 0;     // of the analyzer
+    double allocs_per_token = 0;
+    double cycles_per_byte = 0;
+};
+
+std::uint64_t readCycles() {
+#if defined(DAISY_HAS_RDTSC)
+    return __rdtsc();
+#else
+    return 0;
+#endif
+}
+
+std::size_t writeCorpusFile(const std::filesystem::path& path, const std::string& text) {
+    return writeFile(path.generic_string(), text) ? text.size() : 0;
+}
+
+std::vector<Corpus> makeCorpora(const std::filesystem::path& dir, std::size_t size) {
+    std::vector<Corpus> corpora;
+    auto add_corpus = [&](std::string name, std::string group, const std::string& text) {
+        const auto path = dir / (name + ".ds");
+        const std::size_t bytes = writeCorpusFile(path, text);
+        corpora.push_back(Corpus{std::move(name), std::move(group), path.generic_string(), bytes});
+    };
+
+    add_corpus("identifiers", "lexer", repeatLines(size, makeIdentifierLine));
+    add_corpus("numbers", "lexer", repeatLines(size, [](unsigned n) {
+                   const std::string k = std::to_string(n);
+                   return "const c" + k + " = 0x1f2e_3d4c + " + k + "u64 * 0b1011 - 3.14159e2f64 + 0777 + " + k +
+                          ".5;\n";
+               }));
+    add_corpus("comments", "lexer", repeatLines(size, [](unsigned n) {
+                   return "/* Block comment which describes the next declaration\n"
+                          " * and spans several lines of text */\n"
+                          "// Line comment of the declaration\n"
+                          "let x" +
+                          std::to_string(n) + " = 0;\n";
+               }));
+    add_corpus("strings", "lexer", repeatLines(size, [](unsigned n) {
+                   return "const s" + std::to_string(n) +
+                          " = \"plain string literal\" \"with \\tescapes\\x41\\101\\n\" \"and more text\";\n";
+               }));
+    add_corpus("macros", "preproc",
+               "#define ADD(a, b) ((a) + (b))\n"
+               "#define MUL(a, b) ((a) * (b))\n"
+               "#define ONE 1\n" +
+                   repeatLines(size, [](unsigned n) {
+                       const std::string k = std::to_string(n);
+                       return "let x" + k + " = ADD(MUL(i" + k + ", ONE), ADD(j, MUL(k, 3)));\n";
+                   }));
+    add_corpus("disabled", "preproc", repeatLines(size, [](unsigned n) {
+                   return "#if false\nlet y = \"disabled\" + /* text */ 1;\nlet z = 2;\n#endif\nlet x" +
+                          std::to_string(n) + " = 0;\n";
+               }));
+
+    // Include chain: every header includes the next one, and the main file includes the chain several times
+    const unsigned depth = 64;
+    const std::size_t header_size = size / (8 * depth);
+    std::size_t chain_bytes = 0;
+    for (unsigned n = 0; n < depth; ++n) {
+        std::string text = n + 1 < depth ? "#include \"chain" + std::to_string(n + 1) + ".dsh\"\n" : "";
+        text += repeatLines(header_size, [n](unsigned k) {
+            return "let h" + std::to_string(n) + "_" + std::to_string(k) + " = value + 1;\n";
+        });
+        chain_bytes += writeCorpusFile(dir / ("chain" + std::to_string(n) + ".dsh"), text);
+    }
+    std::string main_text;
+    for (unsigned n = 0; n < 8; ++n) { main_text += "#include \"chain0.dsh\"\n"; }
+    add_corpus("include_chain", "preproc", main_text);
+    corpora.back().bytes += 8 * chain_bytes;
+    return corpora;
+}
+
+// Returns the number of tokens or 0 on error
+std::size_t lexCorpus(const Corpus& corpus, bool use_lexeme_cache, std::size_t* alloc_count = nullptr) {
+    CompilationContext ctx(corpus.main_path);
+    ctx.use_lexeme_cache = use_lexeme_cache;
+    DaisyParserPass pass;
+    pass.configure();
+    if (!pass.beginInput(ctx)) { return 0; }
+    std::size_t tokens = 0;
+    const std::uint64_t alloc_count0 = getThreadAllocCount();
+    SymbolInfo tkn;
+    while (pass.lex(tkn) != parser_detail::tt_end_of_file) { ++tokens; }
+    if (alloc_count) { *alloc_count = static_cast<std::size_t>(getThreadAllocCount() - alloc_count0); }
+    pass.cleanup();
+    return ctx.error_count == 0 ? tokens : 0;
+}
+
+bool measure(const Corpus& corpus, unsigned iterations, Result& result) {
+    const double mbytes = static_cast<double>(corpus.bytes) / (1024 * 1024);
+
+    // Note: the cold run loads files into `SourceFileCache`, lexemes are recorded on the second inclusion of a file,
+    // so one more run fills lexeme caches before the measured runs
+    result.cold_mb_per_s = mbytes / measureSeconds([&] { result.tokens = lexCorpus(corpus, true); });
+    if (!result.tokens || lexCorpus(corpus, true) != result.tokens) { return false; }
+
+    std::vector<double> lex_times, replay_times, lex_cycles;
+    std::size_t alloc_count = 0;
+    for (unsigned i = 0; i < iterations; ++i) {
+        std::size_t count = 0, tokens = 0;
+        const std::uint64_t cycles0 = readCycles();
+        lex_times.push_back(measureSeconds([&] { tokens = lexCorpus(corpus, false, &count); }));
+        lex_cycles.push_back(static_cast<double>(readCycles() - cycles0));
+        if (tokens != result.tokens) { return false; }
+        alloc_count += count;
+
+        replay_times.push_back(measureSeconds([&] { tokens = lexCorpus(corpus, true); }));
+        if (tokens != result.tokens) { return false; }
+    }
+
+    const double lex_time = median(lex_times);
+    result.lex_mb_per_s = mbytes / lex_time;
+    result.replay_mb_per_s = mbytes / median(replay_times);
+    result.tokens_per_s = static_cast<double>(result.tokens) / lex_time;
+    result.allocs_per_token = static_cast<double>(alloc_count) / (static_cast<double>(result.tokens) * iterations);
+    result.cycles_per_byte = median(lex_cycles) / static_cast<double>(corpus.bytes);
+    return true;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    unsigned iterations = 10;
+    double threshold = 5;
+    std::string output_path, baseline_path;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        bool is_valid = true;
+        if (i + 1 == argc) {
+            is_valid = false;
+        } else if (arg == "--iterations") {
+            is_valid = parseArgument(argv[++i], iterations) && iterations > 0;
+        } else if (arg == "--threshold") {
+            is_valid = parseArgument(argv[++i], threshold);
+        } else if (arg == "--output") {
+            output_path = argv[++i];
+        } else if (arg == "--baseline") {
+            baseline_path = argv[++i];
+        } else {
+            is_valid = false;
+        }
+        if (!is_valid) {
+            uxs::println(uxs::stdbuf::log(), "invalid command line argument `{}`", arg);
+            return 1;
+        }
+    }
+
+    std::string baseline;
+    if (!baseline_path.empty() && !readFile(baseline_path, baseline)) {
+        uxs::println(uxs::stdbuf::log(), "could not open baseline file `{}`", baseline_path);
+        return 1;
+    }
+
+    // Note: allocations are counted by the replaced global `operator new` of the compiler
+    PassStatsCollector pass_stats;
+
+    const auto dir = std::filesystem::temp_directory_path() / "daisy-lex-bench";
+    std::filesystem::create_directories(dir);
+    const auto corpora = makeCorpora(dir, 4 * 1024 * 1024);
+
+    std::string json = uxs::format("{{\n  \"iterations\": {},\n  \"corpora\": [", iterations);
+    std::vector<std::string> regressions;
+    for (const Corpus& corpus : corpora) {
+        Result result;
+        if (!measure(corpus, iterations, result)) {
+            uxs::println(uxs::stdbuf::log(), "failed to lex corpus `{}`", corpus.name);
+            return 1;
+        }
+        JsonObject obj;
+        obj.add("name", corpus.name).add("group", corpus.group).add("bytes", corpus.bytes);
+        obj.add("tokens", result.tokens).add("cold_mb_per_s", result.cold_mb_per_s);
+        obj.add("lex_mb_per_s", result.lex_mb_per_s).add("replay_mb_per_s", result.replay_mb_per_s);
+        obj.add("tokens_per_s", result.tokens_per_s).add("allocs_per_token", result.allocs_per_token);
+        if (readCycles() != 0) {
+            obj.add("cycles_per_byte", result.cycles_per_byte);
+        } else {
+            obj.addNull("cycles_per_byte");
+        }
+        json += uxs::format("{}\n    {}", &corpus == &corpora.front() ? "" : ",", obj.str());
+
+        if (baseline.empty()) { continue; }
+        for (const auto& [field, value] :
+             {std::pair{"lex_mb_per_s", result.lex_mb_per_s}, std::pair{"replay_mb_per_s", result.replay_mb_per_s}}) {
+            double base = 0;
+            if (!findBaseline(baseline, corpus.name, field, base)) {
+                uxs::println(uxs::stdbuf::log(), "baseline file `{}` has no `{}` of corpus `{}`", baseline_path, field,
+                             corpus.name);
+                return 1;
+            }
+            if (value < base * (1 - threshold / 100)) {
+                regressions.push_back(uxs::format("{}: {} {} < {} (baseline)", corpus.name, field, value, base));
+            }
+        }
+    }
+    json += "\n  ]\n}\n";
+
+    uxs::stdbuf::out().write(json);
+    if (!output_path.empty() && !writeFile(output_path, json)) {
+        uxs::println(uxs::stdbuf::log(), "could not write output file `{}`", output_path);
+        return 1;
+    }
+
+    for (const auto& msg : regressions) { uxs::println(uxs::stdbuf::log(), "regression: {}", msg); }
+    return regressions.empty() ? 0 : 2;
+}
@@ -0,0 +1,131 @@
+#include "bench_utils.h"
+#include "ctx/include_prefetcher.h"
+#include "ctx/source_file_cache.h"
+#include "daisy_parser_pass.h"
+#include "util/work_stealing_pool.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <memory>
+#include <string>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <sys/resource.h>
+#    define DAISY_HAS_GETRUSAGE 1
+#endif
+
+// Checks that resident memory stays bounded while large source files are streamed. Usage:
+//   daisy-stream-rss-bench [--size <MiB>] [--limit <MiB>]
+// Two equal files of the given size (256 MiB by default) are lexed one after another with include prefetching
+// turned on. The last line of each file reports a diagnostic, so the line index is built over the whole file. The
+// growth of peak resident memory is printed as JSON, and the exit code is nonzero if it exceeds the limit (64 MiB by
+// default). Loading, deduplication, prefetching, lexing and the line index must not make the whole files resident
+
+namespace {
+
+using namespace daisy;
+using namespace daisy::bench;
+
+// Writes the file by lines, so the generator itself does not keep the whole text in memory
+bool writeLargeFile(const std::string& path, std::size_t size) {
+    uxs::filebuf ofile(path.c_str(), "w");
+    for (unsigned n = 0; ofile && size > 0; ++n) {
+        const std::string line = makeIdentifierLine(n);
+        ofile.write(line);
+        size -= std::min(size, line.size());
+    }
+    return ofile && ofile.write("/* unterminated comment block\n");
+}
+
+// Returns peak resident memory in bytes
+std::size_t getPeakRss() {
+#if defined(DAISY_HAS_GETRUSAGE)
+    struct rusage usage {};
+    ::getrusage(RUSAGE_SELF, &usage);
+#    if defined(__APPLE__)
+    return static_cast<std::size_t>(usage.ru_maxrss);
+#    else
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+#    endif
+#else   // defined(DAISY_HAS_GETRUSAGE)
+    return 0;
+#endif  // defined(DAISY_HAS_GETRUSAGE)
+}
+
+// Returns the number of tokens
+std::size_t lexFile(const std::string& path, IncludePrefetcher& prefetcher) {
+    CompilationContext ctx(path);
+    ctx.prefetcher = &prefetcher;
+    DaisyParserPass pass;
+    pass.configure();
+    if (!pass.beginInput(ctx)) { return 0; }
+    std::size_t tokens = 0;
+    SymbolInfo tkn;
+    while (pass.lex(tkn) != parser_detail::tt_end_of_file) { ++tokens; }
+    pass.cleanup();
+    return tokens;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    std::size_t size_mb = 256, limit_mb = 64;
+    for (int i = 1; i < argc; ++i) {
+        const std::string_view arg = argv[i];
+        bool is_valid = true;
+        if (i + 1 == argc) {
+            is_valid = false;
+        } else if (arg == "--size") {
+            is_valid = parseArgument(argv[++i], size_mb) && size_mb > 0;
+        } else if (arg == "--limit") {
+            is_valid = parseArgument(argv[++i], limit_mb) && limit_mb > 0;
+        } else {
+            is_valid = false;
+        }
+        if (!is_valid) {
+            uxs::println(uxs::stdbuf::log(), "invalid command line argument `{}`", arg);
+            return 1;
+        }
+    }
+
+    if (size_mb * 1024 * 1024 < SourceFile::kStreamingThreshold) {
+        uxs::println(uxs::stdbuf::log(), "files smaller than {} MiB are not streamed",
+                     SourceFile::kStreamingThreshold / (1024 * 1024));
+        return 1;
+    }
+
+    const auto dir = std::filesystem::temp_directory_path() / "daisy-stream-rss-bench";
+    std::filesystem::create_directories(dir);
+    const std::string paths[] = {(dir / "first.ds").generic_string(), (dir / "second.ds").generic_string()};
+    for (const auto& path : paths) {
+        if (!writeLargeFile(path, size_mb * 1024 * 1024)) {
+            uxs::println(uxs::stdbuf::log(), "could not write file `{}`", path);
+            return 1;
+        }
+    }
+
+    util::work_stealing_pool io_pool(1);
+    auto prefetcher = std::make_shared<IncludePrefetcher>(io_pool, dir.generic_string(),
+                                                          std::vector<std::string_view>{});
+
+    const std::size_t rss0 = getPeakRss();
+    std::size_t tokens = 0;
+    for (const auto& path : paths) { tokens += lexFile(path, *prefetcher); }
+    const std::size_t growth_mb = (getPeakRss() - rss0) / (1024 * 1024);
+
+    std::filesystem::remove_all(dir);
+    if (tokens == 0) {
+        uxs::println(uxs::stdbuf::log(), "failed to lex files");
+        return 1;
+    }
+
+    JsonObject obj;
+    obj.add("file_mb", size_mb).add("files", 2).add("tokens", tokens);
+    obj.add("rss_growth_mb", growth_mb).add("limit_mb", limit_mb);
+    uxs::println(uxs::stdbuf::out(), "{}", obj.str());
+    if (growth_mb > limit_mb) {
+        uxs::println(uxs::stdbuf::log(), "regression: peak resident memory has grown by {} MiB", growth_mb);
+        return 2;
+    }
+    return 0;
+}
@@ -0,0 +1,102 @@
+#include "bench_utils.h"
+#include "text_utils.h"
+
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <string>
+
+// Compares text scanning kernels on sources where the preprocessor spends most of its time skipping text: long
+// comment blocks and large `#if 0` regions
+
+namespace {
+
+using namespace daisy;
+using namespace daisy::bench;
+
+std::string makeLine(std::mt19937& gen, std::size_t length) {
+    static const char* const words[] = {"value", "result", "=", "+", "next_node", "buffer", "size", "for",
+                                        "return", "0x1234", "count", ";", "loop_count", "get_value", "lhs"};
+    std::uniform_int_distribution<std::size_t> word(0, std::size(words) - 1);
+    std::string line(4, ' ');
+    while (line.size() < length) { line += words[word(gen)], line += ' '; }
+    return line;
+}
+
+// Block comments of 10-40 lines separated by short declarations
+std::string makeCommentCorpus(std::size_t size) {
+    std::mt19937 gen(12345);
+    std::uniform_int_distribution<std::size_t> lines(10, 40), length(30, 100);
+    return repeatLines(size, [&](unsigned) {
+        std::string text = "/*\n";
+        for (std::size_t n = lines(gen); n > 0; --n) { text += " * " + makeLine(gen, length(gen)) + '\n'; }
+        return text + " */\nlet x: i32 = 0;\n";
+    });
+}
+
+// Disabled regions of 20-80 lines of code which contain no directives
+std::string makeDisabledCorpus(std::size_t size) {
+    std::mt19937 gen(54321);
+    std::uniform_int_distribution<std::size_t> lines(20, 80), length(20, 100);
+    return repeatLines(size, [&](unsigned) {
+        std::string text;
+        for (std::size_t n = lines(gen); n > 0; --n) { text += makeLine(gen, length(gen)) + '\n'; }
+        return text + "#endif\n";
+    });
+}
+
+template<typename Func>
+double measure(const std::string& text, unsigned iterations, unsigned& checksum, Func func) {
+    const double elapsed = measureSeconds([&] {
+        for (unsigned i = 0; i < iterations; ++i) {
+            TextRange range{text.data(), text.data() + text.size(), TextPos{1, 1}};
+            while (range.first != range.last) { func(range); }
+            checksum += range.pos.ln;
+        }
+    });
+    return static_cast<double>(text.size()) * iterations / (elapsed * 1e9);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    unsigned iterations = 20;
+    if (argc > 1 && (!parseArgument(argv[1], iterations) || iterations == 0)) {
+        uxs::println(uxs::stdbuf::log(), "invalid command line argument `{}`", argv[1]);
+        return 1;
+    }
+    const std::string comments = makeCommentCorpus(16 << 20);
+    const std::string disabled = makeDisabledCorpus(16 << 20);
+
+    const auto skip_comments = [](TextRange& range) {
+        range.first += 2, range.pos.col += 2;  // skip "/*"
+        skipCommentBlock(range);
+        skipTillNewLine(range);
+        range.first = std::min(range.first + 1, range.last), range.pos.nextLn();  // skip '\n'
+        skipTillNewLine(range);                                                   // skip declaration
+        range.first = std::min(range.first + 1, range.last), range.pos.nextLn();
+    };
+    const auto skip_disabled = [](TextRange& range) {
+        skipTillPreprocDirective(range);
+        skipTillNewLine(range);  // skip "endif"
+        range.first = std::min(range.first + 1, range.last), range.pos.nextLn();
+    };
+
+    static const char* const names[] = {"scalar", "sse2", "avx2"};
+    unsigned reference_checksum = 0;
+    for (TextScanKernel kernel : {TextScanKernel::kScalar, TextScanKernel::kSse2, TextScanKernel::kAvx2}) {
+        if (!setTextScanKernel(kernel)) { continue; }
+        unsigned checksum = 0;
+        const double comment_rate = measure(comments, iterations, checksum, skip_comments);
+        const double disabled_rate = measure(disabled, iterations, checksum, skip_disabled);
+        if (kernel == TextScanKernel::kScalar) {
+            reference_checksum = checksum;
+        } else if (checksum != reference_checksum) {
+            uxs::println(uxs::stdbuf::log(), "scanning results differ");
+            return 1;
+        }
+        uxs::println(uxs::stdbuf::out(), "{}: comments {:.2f} GB/s, #if 0 {:.2f} GB/s",
+                     names[static_cast<unsigned>(kernel)], comment_rate, disabled_rate);
+    }
+    return 0;
+}
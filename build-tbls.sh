@@ -1,5 +1,8 @@
 #!/bin/bash -e
 LEXEGEN_PATH=${LEXEGEN_PATH:-lexegen}
 PARSEGEN_PATH=${PARSEGEN_PATH:-parsegen}
-$LEXEGEN_PATH src/passes/daisy_parser_pass/daisy.lex --header-file=src/passes/daisy_parser_pass/lex_defs.h --outfile=src/passes/daisy_parser_pass/lex_analyzer.inl
-$PARSEGEN_PATH src/passes/daisy_parser_pass/daisy.gr --header-file=src/passes/daisy_parser_pass/parser_defs.h --outfile=src/passes/daisy_parser_pass/parser_analyzer.inl
+NARROW_TABLES_PATH=${NARROW_TABLES_PATH:-narrow-tables}
+OUTPUT_DIR=${OUTPUT_DIR:-src/passes/daisy_parser_pass}
+$LEXEGEN_PATH src/passes/daisy_parser_pass/daisy.lex --header-file=$OUTPUT_DIR/lex_defs.h --outfile=$OUTPUT_DIR/lex_analyzer.inl
+$PARSEGEN_PATH src/passes/daisy_parser_pass/daisy.gr --header-file=$OUTPUT_DIR/parser_defs.h --outfile=$OUTPUT_DIR/parser_analyzer.inl
+$NARROW_TABLES_PATH $OUTPUT_DIR/lex_analyzer.inl $OUTPUT_DIR/parser_analyzer.inl
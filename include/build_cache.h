@@ -0,0 +1,32 @@
+#pragma once
+
+#include "pass_manager.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace daisy {
+
+struct CompilationContext;
+
+// On-disk cache of compilation results. An entry is keyed by a hash of the compilation settings and the main file
+// path, and is valid while all source files read by the compilation keep their contents and all files probed by
+// `#include` and not found are still missing. A hit replays captured messages without running passes.
+class BuildCache {
+ public:
+    explicit BuildCache(std::string dir) : dir_(std::move(dir)) {}
+
+    // Returns `true` if a valid entry is found; fills `result`, `output` and `dependencies` (if specified) from it
+    bool lookup(std::uint64_t key, PassResult& result, std::string& output,
+                std::vector<std::string>* dependencies = nullptr) const;
+    void store(std::uint64_t key, const CompilationContext& ctx, PassResult result, std::string_view output) const;
+
+ private:
+    std::string dir_;
+
+    std::string makeEntryPath(std::uint64_t key) const;
+};
+
+}  // namespace daisy
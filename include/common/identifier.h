@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace daisy {
+
+// Identifier interned in the process-wide table: each distinct name is stored once together with its hash, so
+// identifiers are compared as pointers and hashed without touching the text.
+// Note: identifiers stay valid across compilation contexts while the table is in use; it is cleared when it exceeds
+// the limit and no compilation uses it, so a long-running compile server does not grow without bound
+class Identifier {
+ public:
+    struct Entry {
+        std::size_t hash;
+        std::string_view text;
+    };
+
+    // Keeps interned names alive while the object is alive, e.g. for the time of a compilation
+    class TableUse {
+     public:
+        TableUse();
+        ~TableUse();
+        TableUse(const TableUse&) = delete;
+        TableUse& operator=(const TableUse&) = delete;
+    };
+
+    // Returns the number of times the table has been cleared; identifiers kept from an older epoch, e.g. in lexeme
+    // caches, are no longer valid
+    static std::uint64_t getTableEpoch() noexcept;
+
+    static constexpr std::size_t kMaxTableSize = 1 << 20;  // entries
+
+    Identifier() noexcept = default;  // empty identifier
+    explicit Identifier(std::string_view text) : entry_(intern(text)) {}
+
+    bool empty() const noexcept { return !entry_; }
+    std::string_view getText() const noexcept { return entry_ ? entry_->text : std::string_view(); }
+    std::size_t getHash() const noexcept { return entry_ ? entry_->hash : 0; }
+
+    friend bool operator==(Identifier lhs, Identifier rhs) noexcept { return lhs.entry_ == rhs.entry_; }
+
+ private:
+    const Entry* entry_ = nullptr;
+
+    static const Entry* intern(std::string_view text);
+};
+
+}  // namespace daisy
+
+template<>
+struct std::hash<daisy::Identifier> {
+    std::size_t operator()(daisy::Identifier id) const noexcept { return id.getHash(); }
+};
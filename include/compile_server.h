@@ -0,0 +1,17 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+namespace daisy {
+
+// Listens on local socket `socket_path` and runs received compilation requests on a pool of `thread_count` threads.
+// Configured passes and caches stay resident between requests. Returns only on error.
+int runCompileServer(std::string_view socket_path, unsigned thread_count);
+
+// Forwards the command line to the compile server listening on `socket_path`. Returns `false` if the server is not
+// reachable, otherwise stores server exit code to `ret_code`, and relays its messages and output.
+bool forwardToCompileServer(std::string_view socket_path, int argc, char** argv, const std::string& working_dir,
+                            int& ret_code, std::string& out);
+
+}  // namespace daisy
@@ -1,37 +1,52 @@
 #pragma once
 
+#include "common/identifier.h"
+#include "ctx/source_file_cache.h"
 #include "ir/nodes/root_node.h"
+#include "pass_manager.h"
+#include "util/string_arena.h"
 
+#include <atomic>
 #include <forward_list>
 #include <string>
 #include <vector>
 
+namespace util {
+class work_stealing_pool;
+}
+
 namespace daisy {
 
+class IncludePrefetcher;
+class PassStatsCollector;
 struct CompilationContext;
 
 struct InputFileInfo {
     enum class Flags : unsigned { kNone = 0, kOnce = 1 };
-    InputFileInfo(CompilationContext* ctx, std::string fname) : compilation_ctx(ctx), file_name(std::move(fname)) {}
-    TextRange getText() const { return TextRange{text.get(), text.get() + text_size, TextPos{1, 1}}; }
+    InputFileInfo(CompilationContext* ctx, std::string fname, std::shared_ptr<const SourceFile> src)
+        : compilation_ctx(ctx), file_name(std::move(fname)), source(std::move(src)) {}
+    TextRange getText() const { return source->getText(); }
+    // Note: `flags` and `guard_macro` are tracked by the origin for all paths of the same file
+    const InputFileInfo& getOrigin() const { return origin ? *origin : *this; }
     const CompilationContext* compilation_ctx;
     std::string file_name;
-    std::size_t text_size = 0;
-    std::vector<std::string_view> text_lines;
-    std::unique_ptr<char[]> text;
-    mutable Flags flags = Flags::kNone;
+    std::shared_ptr<const SourceFile> source;  // shared with other compilation contexts
+    FileId file_id;
+    const InputFileInfo* origin = nullptr;  // the same file reached by another path first
+    mutable Flags flags = Flags::kNone;     // per compilation context
+    mutable Identifier guard_macro;         // the file is skipped while this macro is defined
 };
 UXS_IMPLEMENT_BITWISE_OPS_FOR_ENUM(InputFileInfo::Flags);
 
 struct MacroDefinition {
     enum class Type : unsigned { kUserDefined = 0, kBuiltIn };
-    MacroDefinition(Type t, std::string_view i, bool v = false) : type(t), id(i), is_variadic(v) {}
+    MacroDefinition(Type t, Identifier i, bool v = false) : type(t), id(i), is_variadic(v) {}
     Type type;
-    std::string_view id;
+    Identifier id;
     bool is_variadic;
     SymbolLoc loc;
     TextRange text;
-    std::unordered_map<std::string_view, std::pair<unsigned, SymbolLoc>> formal_args;
+    std::unordered_map<Identifier, std::pair<unsigned, SymbolLoc>> formal_args;
 };
 constexpr MacroDefinition::Type operator+(MacroDefinition::Type type, unsigned n) {
     return static_cast<MacroDefinition::Type>(static_cast<unsigned>(type) + n);
@@ -40,17 +55,70 @@ constexpr unsigned operator-(MacroDefinition::Type lhs, MacroDefinition::Type rh
     return static_cast<unsigned>(lhs) - static_cast<unsigned>(rhs);
 }
 
+// Base of analysis results cached in `CompilationContext` until invalidated by a transform pass
+struct AnalysisResult {
+    virtual ~AnalysisResult() = default;
+};
+
+// Note: failed analyses are cached too, so their diagnostics are not repeated for each consumer
+struct AnalysisState {
+    PassResult pass_result = PassResult::kSuccess;
+    std::unique_ptr<AnalysisResult> result;  // `nullptr` if the analysis has failed or stored nothing
+};
+
 struct CompilationContext {
     explicit CompilationContext(std::string fname) : file_name(std::move(fname)) {}
+
+    bool isAnalysisValid(std::string_view name) const { return analysis_results.find(name) != analysis_results.end(); }
+    PassResult getAnalysisPassResult(std::string_view name) const {
+        auto it = analysis_results.find(name);
+        return it != analysis_results.end() ? it->second.pass_result : PassResult::kSuccess;
+    }
+    void setAnalysisPassResult(std::string_view name, PassResult pass_result) {
+        analysis_results[name].pass_result = pass_result;
+    }
+    void setAnalysisResult(std::string_view name, std::unique_ptr<AnalysisResult> result) {
+        analysis_results[name].result = std::move(result);
+    }
+    template<typename Ty>
+    Ty* getAnalysisResult(std::string_view name) const {
+        auto it = analysis_results.find(name);
+        return it != analysis_results.end() ? static_cast<Ty*>(it->second.result.get()) : nullptr;
+    }
+    template<typename Pred>
+    void invalidateAnalyses(Pred pred) {
+        for (auto it = analysis_results.begin(); it != analysis_results.end();) {
+            it = pred(it->first) ? analysis_results.erase(it) : std::next(it);
+        }
+    }
+
+    Identifier::TableUse identifier_table_use;  // identifiers of the compilation must stay valid
     std::string file_name;
+    std::string working_dir;
     std::unique_ptr<ir::RootNode> ir_root;
     std::unordered_map<std::string, std::unique_ptr<InputFileInfo>> input_files;
+    std::unordered_map<FileId, const InputFileInfo*, FileIdHash> input_files_by_id;
+    std::vector<std::string_view> dependencies;  // normalized paths of `input_files` in order of first inclusion
+    std::vector<std::string> missing_files;      // normalized paths probed by `#include` and not found
     std::vector<std::string_view> include_paths;
-    std::unordered_map<std::string_view, std::unique_ptr<MacroDefinition>> macro_defs;
+    std::unordered_map<Identifier, std::unique_ptr<MacroDefinition>> macro_defs;
+    // Note: locations of expanded tokens refer to their macro definitions, so replaced and undefined definitions are
+    // kept until the end of compilation; tokens are lexed ahead of the parser and can outlive the definition
+    std::vector<std::unique_ptr<MacroDefinition>> retired_macro_defs;
     std::forward_list<std::string> input_strings;
+    util::string_arena literal_strings;  // string literals which differ from their source text
+    util::string_arena joined_strings;   // chains of adjacent string literals joined by the parser
     std::forward_list<LocationContext> loc_ctx_list;
-    mutable unsigned warning_count = 0;
-    mutable unsigned error_count = 0;
+    std::unordered_map<std::string_view, AnalysisState> analysis_results;
+    util::work_stealing_pool* pool = nullptr;  // for function-level parallelism if specified
+    IncludePrefetcher* prefetcher = nullptr;
+    PassStatsCollector* pass_stats = nullptr;  // passes are measured if specified
+    bool pipelined_parsing = false;  // preprocess on a separate thread while parsing
+    bool use_lexeme_cache = true;    // replay and record lexemes of source files, see `LexemeCache`
+    bool run_test_passes = false;    // run passes checking the pass manager, see `src/passes/test_passes`
+    // Note: messages can be reported concurrently by function passes
+    mutable std::atomic<unsigned> warning_count{0};
+    mutable std::atomic<unsigned> error_count{0};
 };
 
 }  // namespace daisy
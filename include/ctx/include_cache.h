@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace daisy {
+
+// Process-wide cache of `#include` resolution results, including failed lookups. A result depends on the working
+// directory, the directory of the including file, the requested name and the include search paths.
+// Note: a resolved file is validated when it is opened, and a result is dropped if any of the paths probed before it
+// has appeared since. These paths are checked on the first lookup in each generation, e.g. the compile server starts a
+// new one for each request, so results are reused by concurrent requests without clearing the cache. Least recently
+// used results are evicted when the number of cached results exceeds the limit.
+class IncludeCache {
+ public:
+    static IncludeCache& getInstance();
+
+    static std::string makeKey(std::string_view working_dir, std::string_view including_dir,
+                               const std::vector<std::string_view>& include_paths, std::string_view file_name);
+
+    struct Entry {
+        std::string resolved_path;               // empty string if the file was not found
+        std::vector<std::string> missing_paths;  // normalized paths probed before the resolved one
+    };
+
+    // Returns `nullptr` if the result is not cached or outdated
+    std::shared_ptr<const Entry> find(const std::string& key);
+    void add(std::string key, Entry entry);
+    void startGeneration() { generation_.fetch_add(1, std::memory_order_relaxed); }
+
+    static constexpr std::size_t kMaxEntryCount = 65536;
+
+ private:
+    struct CachedEntry {
+        CachedEntry(Entry e, std::uint64_t gen, std::uint64_t use)
+            : entry(std::move(e)), generation(gen), last_use(use) {}
+        Entry entry;
+        std::atomic<std::uint64_t> generation;  // the last generation the entry was validated in
+        std::atomic<std::uint64_t> last_use;    // value of `use_count_` at the last lookup
+    };
+
+    std::shared_mutex mtx_;
+    std::atomic<std::uint64_t> generation_{0};
+    std::atomic<std::uint64_t> use_count_{0};
+    std::unordered_map<std::string, std::shared_ptr<CachedEntry>> resolved_;
+
+    void evictEntries();
+};
+
+}  // namespace daisy
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <vector>
+
+namespace util {
+class work_stealing_pool;
+}
+
+namespace daisy {
+
+struct SourceFile;
+
+// Scans loaded source files for `#include "..."` lines and loads referenced files into `SourceFileCache` on
+// background I/O threads, so they are already resident when the preprocessor reaches them. Include files are
+// resolved the same way as the preprocessor does, but conditional sections are not taken into account. Scanning is
+// done on I/O threads too; a file which is being prefetched is waited for by `SourceFileCache::getFile`, so it is
+// never loaded twice.
+// Note: pending tasks turn into no-ops after the prefetcher is destroyed
+class IncludePrefetcher : public std::enable_shared_from_this<IncludePrefetcher> {
+ public:
+    IncludePrefetcher(util::work_stealing_pool& pool, std::string working_dir,
+                      const std::vector<std::string_view>& include_paths);
+
+    void prefetchIncludes(const std::string& normal_path, std::shared_ptr<const SourceFile> file);
+
+    static std::vector<std::string_view> scanIncludes(std::string_view text);
+
+ private:
+    util::work_stealing_pool& pool_;
+    std::string working_dir_;
+    std::vector<std::string> include_paths_;
+    std::mutex mtx_;
+    std::unordered_set<std::string> visited_;
+
+    void scanFile(const std::string& normal_path, const SourceFile& file);
+    void prefetchFile(const std::string& including_dir, std::string_view file_name);
+};
+
+}  // namespace daisy
@@ -0,0 +1,56 @@
+#pragma once
+
+#include "common/identifier.h"
+#include "ir/float_const.h"
+#include "ir/int_const.h"
+
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+namespace daisy {
+
+// Lexemes of a source file recorded while the file is lexed for the first time, so next inclusions of the file (also
+// by other compilation contexts) replay them instead of running the lexical analyzer over the same text again.
+// A lexeme depends only on its offset and the analyzer start state, so it is replayed wherever the text is lexed in
+// the same state, and the preprocessor still works on the text itself. Positions which have not been lexed on the
+// first pass (e.g. in skipped conditional sections) are analyzed as usual.
+// Note: lexemes are recorded on the second inclusion of a file, so files lexed only once do not pay for recording,
+// and caches of all files share the memory budget of `kMaxTotalSize` bytes
+struct LexemeCache {
+    static constexpr std::uint32_t kNoValue = ~std::uint32_t(0);
+    static constexpr std::size_t kMaxTextSize = std::numeric_limits<std::uint32_t>::max();  // offsets are 32-bit
+    static constexpr std::size_t kMaxTotalSize = 256 * 1024 * 1024;
+
+    struct Lexeme {
+        std::uint32_t offset;
+        std::uint32_t length;
+        std::uint32_t value;  // token type of a keyword or index in `ids`, `int_consts` or `float_consts`
+        std::uint8_t pat;
+        bool at_beg_of_line;
+        bool is_keyword;
+    };
+
+    // Returns the lexeme at `offset` or `nullptr`; `cursor` tracks sequential lookups with increasing offsets
+    const Lexeme* find(std::uint32_t offset, bool at_beg_of_line, std::size_t& cursor) const {
+        while (cursor != lexemes.size() && lexemes[cursor].offset < offset) { ++cursor; }
+        if (cursor == lexemes.size() || lexemes[cursor].offset != offset ||
+            lexemes[cursor].at_beg_of_line != at_beg_of_line) {
+            return nullptr;
+        }
+        return &lexemes[cursor];
+    }
+
+    std::size_t getMemorySize() const {
+        return sizeof(LexemeCache) + lexemes.capacity() * sizeof(Lexeme) + ids.capacity() * sizeof(Identifier) +
+               int_consts.capacity() * sizeof(ir::IntConst) + float_consts.capacity() * sizeof(ir::FloatConst);
+    }
+
+    std::uint64_t id_epoch = 0;   // `Identifier::getTableEpoch()` at recording, `ids` are valid only in this epoch
+    std::vector<Lexeme> lexemes;  // sorted by offset
+    std::vector<Identifier> ids;
+    std::vector<ir::IntConst> int_consts;
+    std::vector<ir::FloatConst> float_consts;
+};
+
+}  // namespace daisy
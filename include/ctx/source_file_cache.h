@@ -0,0 +1,119 @@
+#pragma once
+
+#include "common/symbol_loc.h"
+
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace daisy {
+
+struct LexemeCache;
+
+// Identifies a file regardless of the path it is reached by, e.g. through symbolic links
+struct FileId {
+    std::uint64_t device = 0;
+    std::uint64_t inode = 0;
+    friend bool operator==(const FileId& lhs, const FileId& rhs) {
+        return lhs.device == rhs.device && lhs.inode == rhs.inode;
+    }
+    friend bool operator!=(const FileId& lhs, const FileId& rhs) { return !(lhs == rhs); }
+};
+
+struct FileIdHash {
+    std::size_t operator()(const FileId& id) const { return std::hash<std::uint64_t>{}(id.inode ^ (id.device << 40)); }
+};
+
+// Immutable contents of a source file shared by all compilation contexts which include it. Regular files are
+// memory-mapped, so text points directly into the mapping; other files (e.g. pipes) are read into `buffer`.
+// Note: the lexer ends the text at the first '\0', which it searches lazily, so loading never scans the whole file
+// Note: a mapped file must not be rewritten in place while it is in use (editors and build tools replace files)
+struct SourceFile {
+    SourceFile() = default;
+    ~SourceFile();
+    SourceFile(const SourceFile&) = delete;
+    SourceFile& operator=(const SourceFile&) = delete;
+    TextRange getText() const { return TextRange{text, text + text_size, TextPos{1, 1}}; }
+    std::string_view getContent() const { return std::string_view(text, text_size); }
+
+    // Large mapped files are streamed: text which has been consumed is returned to the system by `releasePages`,
+    // so resident memory scales with the working set rather than with file size
+    bool isStreamed() const { return mapping && text_size >= kStreamingThreshold; }
+    // Note: released pages are transparently reloaded from the file on next access, e.g. by diagnostics
+    void releasePages(const char* first, const char* last) const;
+
+    // Returns cached lexemes of the file or `nullptr` if they have not been recorded yet
+    const LexemeCache* getLexemeCache() const { return lexeme_cache.load(std::memory_order_acquire); }
+    // Returns the number of previous inclusions of the file, which are counted while lexemes are not cached
+    unsigned addInclusion() const { return inclusion_count.fetch_add(1, std::memory_order_relaxed); }
+    // Note: only the first published cache is kept, concurrently recorded ones are dropped; a cache which does not fit
+    // into the total budget of `LexemeCache::kMaxTotalSize` is dropped too
+    void publishLexemeCache(std::unique_ptr<LexemeCache> cache) const;
+
+    // Returns the hash of the text; note: it is computed on the first call, only the build cache needs it
+    std::uint64_t getContentHash() const;
+
+    // Returns the line without '\n'; line numbers start from 1
+    // Note: the line index is extended on demand up to the requested line, usually only diagnostics need it
+    std::string_view getLine(unsigned ln) const;
+
+    static constexpr std::size_t kStreamingThreshold = 64 * 1024 * 1024;
+    static constexpr std::size_t kStreamingWindow = 8 * 1024 * 1024;
+    const char* text = nullptr;
+    std::size_t text_size = 0;
+    mutable std::once_flag content_hash_once;
+    mutable std::uint64_t content_hash = 0;
+    static constexpr unsigned kLineIndexStep = 64;
+    mutable std::mutex line_index_mtx;
+    mutable std::vector<std::uint32_t> line_offsets;  // offsets of every `kLineIndexStep`-th line start
+    mutable std::vector<std::uint64_t> line_offsets64;  // used instead for files larger than 4 GiB
+    mutable std::atomic<const LexemeCache*> lexeme_cache{nullptr};  // owned by the file
+    mutable std::atomic<unsigned> inclusion_count{0};
+    std::vector<char> buffer;
+    void* mapping = nullptr;
+    std::size_t mapping_size = 0;
+
+ private:
+    template<typename Offset>
+    std::string_view getIndexedLine(std::vector<Offset>& offsets, unsigned ln) const;
+};
+
+// Process-wide thread-safe cache of loaded source files. Files are looked up by normalized path and validated by
+// modification time and size; files with equal contents share the same `SourceFile`, they are found among the files
+// of the same size. Least recently used paths are evicted when the number of cached paths exceeds the limit. A file
+// is loaded by one thread at a time, other threads looking up the same path wait for the result.
+// Note: streamed files are not compared with other files, that would make the whole files resident
+class SourceFileCache {
+ public:
+    static SourceFileCache& getInstance();
+
+    // Returns `nullptr` if the file could not be opened or read; stores file identity to `file_id` if specified
+    std::shared_ptr<const SourceFile> getFile(const std::string& normal_path, FileId* file_id = nullptr);
+
+    static constexpr std::size_t kMaxPathCount = 4096;
+
+ private:
+    struct PathEntry {
+        std::int64_t mtime = 0;  // nanoseconds
+        std::uint64_t file_size = 0;
+        std::uint64_t last_use = 0;  // value of `use_count_` at the last lookup
+        std::shared_ptr<const SourceFile> file;
+    };
+
+    std::mutex mtx_;
+    std::uint64_t use_count_ = 0;
+    std::unordered_map<std::string, PathEntry> by_path_;
+    std::unordered_map<std::string, std::shared_future<std::shared_ptr<const SourceFile>>> loading_;
+    std::unordered_multimap<std::size_t, std::weak_ptr<const SourceFile>> by_size_;
+
+    void evictPaths();
+    static std::unique_ptr<SourceFile> loadFile(const std::string& normal_path);
+};
+
+}  // namespace daisy
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+
+namespace util {
+class work_stealing_pool;
+}
+
+namespace daisy {
+
+struct DriverEnvironment {
+    std::string working_dir;
+    util::work_stealing_pool* pool = nullptr;  // used for parallel compilation if specified
+    bool is_server_request = false;
+};
+
+// Parses the command line and performs requested actions. Messages are printed to the logger output of the calling
+// thread, other output (help, version, reports) is appended to `out`
+int runCompiler(int argc, char** argv, const DriverEnvironment& env, std::string& out);
+
+}  // namespace daisy
@@ -1,10 +1,10 @@
 #pragma once
 
+#include "common/identifier.h"
 #include "util/rtti.h"
 
 #include <uxs/iterator.h>
 
-#include <string_view>
 #include <unordered_map>
 
 namespace daisy {
@@ -17,7 +17,7 @@ class DefNode;
 
 class Namespace {
  private:
-    using NameTableType = std::unordered_multimap<std::string_view, NamedNode*>;
+    using NameTableType = std::unordered_multimap<Identifier, NamedNode*>;
 
  public:
     using value_type = typename NameTableType::value_type;
@@ -44,7 +44,7 @@ class Namespace {
     Node* getParentScope() { return parent_scope_; }
 
     template<typename Ty>
-    const Ty* findNode(std::string_view name) const {
+    const Ty* findNode(Identifier name) const {
         for (const auto& item : uxs::make_range(name_table_.equal_range(name))) {
             if (const auto* obj = util::cast<const Ty*>(item.second); obj) { return obj; }
         }
@@ -52,12 +52,12 @@ class Namespace {
     }
 
     template<typename Ty>
-    Ty* findNode(std::string_view name) {
+    Ty* findNode(Identifier name) {
         return const_cast<Ty*>(std::as_const(*this).findNode<Ty>(name));
     }
 
     template<typename Ty, typename Pred>
-    const Ty* findNode(std::string_view name, Pred p) const {
+    const Ty* findNode(Identifier name, Pred p) const {
         for (const auto& item : uxs::make_range(name_table_.equal_range(name))) {
             if (const auto* obj = util::cast<const Ty*>(item.second); obj && p(*obj)) { return obj; }
         }
@@ -65,7 +65,7 @@ class Namespace {
     }
 
     template<typename Ty, typename Pred>
-    Ty* findNode(std::string_view name, Pred p) {
+    Ty* findNode(Identifier name, Pred p) {
         return const_cast<Ty*>(std::as_const(*this).findNode<Ty>(name, p));
     }
 
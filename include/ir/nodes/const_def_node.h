@@ -7,7 +7,7 @@ namespace ir {
 
 class ConstDefNode : public util::rtti_mixin<ConstDefNode, DefNode> {
  public:
-    ConstDefNode(std::string name, const SymbolLoc& loc) : rtti_mixin_t(std::move(name), loc) {}
+    ConstDefNode(Identifier name, const SymbolLoc& loc) : rtti_mixin_t(name, loc) {}
 };
 
 }  // namespace ir
@@ -8,9 +8,9 @@ namespace ir {
 
 class DefNode : public util::rtti_mixin<DefNode, NamedNode> {
  public:
-    DefNode(std::string name, const SymbolLoc& loc) : rtti_mixin_t(std::move(name), loc) {}
-    DefNode(std::string name, std::unique_ptr<Namespace> nmspace, const SymbolLoc& loc)
-        : rtti_mixin_t(std::move(name), std::move(nmspace), loc) {}
+    DefNode(Identifier name, const SymbolLoc& loc) : rtti_mixin_t(name, loc) {}
+    DefNode(Identifier name, std::unique_ptr<Namespace> nmspace, const SymbolLoc& loc)
+        : rtti_mixin_t(name, std::move(nmspace), loc) {}
 
     const TypeDescriptor& getTypeDescriptor() const { return type_desc_; }
     TypeDescriptor& getTypeDescriptor() { return type_desc_; }
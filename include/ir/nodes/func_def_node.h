@@ -9,8 +9,8 @@ enum class FuncProtoCompareResult { kEqual = 0, kRetTypeDiff, kArgTypeDiff, kArg
 
 class FuncDefNode : public util::rtti_mixin<FuncDefNode, DefNode> {
  public:
-    FuncDefNode(std::string name, Node& parent_scope, const SymbolLoc& loc)
-        : rtti_mixin_t(std::move(name), std::make_unique<Namespace>(parent_scope), loc) {}
+    FuncDefNode(Identifier name, Node& parent_scope, const SymbolLoc& loc)
+        : rtti_mixin_t(name, std::make_unique<Namespace>(parent_scope), loc) {}
 
     bool isDefined() const { return is_defined_; }
     const SymbolLoc& getDefinitionLoc() const { return def_loc_; }
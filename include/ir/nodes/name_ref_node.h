@@ -9,15 +9,15 @@ namespace ir {
 
 class NameRefNode : public util::rtti_mixin<NameRefNode, EvalNode> {
  public:
-    NameRefNode(std::string name, ScopeDescriptor scope_desc, const SymbolLoc& loc)
-        : rtti_mixin_t(loc), name_(std::move(name)), scope_desc_(std::move(scope_desc)) {}
+    NameRefNode(Identifier name, ScopeDescriptor scope_desc, const SymbolLoc& loc)
+        : rtti_mixin_t(loc), name_(name), scope_desc_(std::move(scope_desc)) {}
 
-    const std::string& getName() const { return name_; }
+    Identifier getName() const { return name_; }
     const NamedNode* getNamedNode() const { return named_node_; }
     NamedNode* getNamedNode() { return named_node_; }
 
  private:
-    std::string name_;
+    Identifier name_;
     ScopeDescriptor scope_desc_;
     NamedNode* named_node_ = nullptr;
 };
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "common/identifier.h"
 #include "ir/nodes/node.h"
 
 #include <string>
@@ -9,15 +10,15 @@ namespace ir {
 
 class NamedNode : public util::rtti_mixin<NamedNode, Node> {
  public:
-    NamedNode(std::string name, const SymbolLoc& loc) : rtti_mixin_t(loc), name_(std::move(name)) {}
-    NamedNode(std::string name, std::unique_ptr<Namespace> nmspace, const SymbolLoc& loc)
-        : rtti_mixin_t(std::move(nmspace), loc), name_(std::move(name)) {}
+    NamedNode(Identifier name, const SymbolLoc& loc) : rtti_mixin_t(loc), name_(name) {}
+    NamedNode(Identifier name, std::unique_ptr<Namespace> nmspace, const SymbolLoc& loc)
+        : rtti_mixin_t(std::move(nmspace), loc), name_(name) {}
 
-    const std::string& getName() const { return name_; }
+    Identifier getName() const { return name_; }
     std::string getGlobalName() const;
 
  private:
-    std::string name_;
+    Identifier name_;
 };
 
 }  // namespace ir
@@ -7,8 +7,8 @@ namespace ir {
 
 class NamedScopeNode : public util::rtti_mixin<NamedScopeNode, NamedNode> {
  public:
-    NamedScopeNode(std::string name, Node& parent_scope, const SymbolLoc& loc)
-        : rtti_mixin_t(std::move(name), std::make_unique<Namespace>(parent_scope), loc) {}
+    NamedScopeNode(Identifier name, Node& parent_scope, const SymbolLoc& loc)
+        : rtti_mixin_t(name, std::make_unique<Namespace>(parent_scope), loc) {}
 };
 
 }  // namespace ir
@@ -7,8 +7,8 @@ namespace ir {
 
 class NamespaceNode : public util::rtti_mixin<NamespaceNode, NamedScopeNode> {
  public:
-    NamespaceNode(std::string name, Node& parent_scope, const SymbolLoc& loc)
-        : rtti_mixin_t(std::move(name), parent_scope, loc) {}
+    NamespaceNode(Identifier name, Node& parent_scope, const SymbolLoc& loc)
+        : rtti_mixin_t(name, parent_scope, loc) {}
 };
 
 }  // namespace ir
@@ -7,12 +7,13 @@ namespace ir {
 
 class StringConstNode : public util::rtti_mixin<StringConstNode, EvalNode> {
  public:
-    explicit StringConstNode(std::string v, const SymbolLoc& loc) : rtti_mixin_t(loc), val_(std::move(v)) {}
+    // Note: the value refers to the source text or to the string arena of compilation context
+    explicit StringConstNode(std::string_view v, const SymbolLoc& loc) : rtti_mixin_t(loc), val_(v) {}
 
-    const std::string& getValue() const { return val_; }
+    std::string_view getValue() const { return val_; }
 
  private:
-    std::string val_;
+    std::string_view val_;
 };
 
 }  // namespace ir
@@ -7,8 +7,8 @@ namespace ir {
 
 class StructDefNode : public util::rtti_mixin<StructDefNode, TypeDefNode> {
  public:
-    StructDefNode(std::string name, Node& parent_scope, const SymbolLoc& loc)
-        : rtti_mixin_t(std::move(name), parent_scope, loc) {}
+    StructDefNode(Identifier name, Node& parent_scope, const SymbolLoc& loc)
+        : rtti_mixin_t(name, parent_scope, loc) {}
 };
 
 }  // namespace ir
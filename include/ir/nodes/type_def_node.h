@@ -7,8 +7,8 @@ namespace ir {
 
 class TypeDefNode : public util::rtti_mixin<TypeDefNode, NamedScopeNode> {
  public:
-    TypeDefNode(std::string name, Node& parent_scope, const SymbolLoc& loc)
-        : rtti_mixin_t(std::move(name), parent_scope, loc) {}
+    TypeDefNode(Identifier name, Node& parent_scope, const SymbolLoc& loc)
+        : rtti_mixin_t(name, parent_scope, loc) {}
 };
 
 }  // namespace ir
@@ -7,7 +7,7 @@ namespace ir {
 
 class VarDefNode : public util::rtti_mixin<VarDefNode, DefNode> {
  public:
-    VarDefNode(std::string name, const SymbolLoc& loc) : rtti_mixin_t(std::move(name), loc) {}
+    VarDefNode(Identifier name, const SymbolLoc& loc) : rtti_mixin_t(name, loc) {}
 };
 
 }  // namespace ir
@@ -14,9 +14,9 @@ class ScopeDescriptor {
 
     ScopeClass getClass() const { return class_; }
     template<typename Ty>
-    const Ty* lookupName(std::string_view name) const;
+    const Ty* lookupName(Identifier name) const;
     template<typename Ty>
-    Ty* lookupName(std::string_view name) {
+    Ty* lookupName(Identifier name) {
         return const_cast<Ty*>(std::as_const(*this).lookupName<Ty>(name));
     }
 
@@ -26,7 +26,7 @@ class ScopeDescriptor {
 };
 
 template<typename Ty>
-const Ty* ScopeDescriptor::lookupName(std::string_view name) const {
+const Ty* ScopeDescriptor::lookupName(Identifier name) const {
     assert(!name.empty());
     switch (class_) {
         case ScopeClass::kLocal: {
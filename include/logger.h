@@ -10,7 +10,44 @@ struct CompilationContext;
 
 namespace logger {
 
-extern unsigned g_debug_level;
+extern thread_local unsigned g_debug_level;
+
+// Redirects messages of the calling thread into `buf` while the object is alive
+class OutputCapture {
+ public:
+    explicit OutputCapture(std::string& buf) : OutputCapture(&buf) {}
+    explicit OutputCapture(std::string* buf);  // Note: `nullptr` - restores direct output
+    ~OutputCapture();
+    static std::string* getBuffer();
+    OutputCapture(const OutputCapture&) = delete;
+    OutputCapture& operator=(const OutputCapture&) = delete;
+
+ private:
+    std::string* prev_buf_;
+};
+
+// Sets debug level of the calling thread while the object is alive; note: pool threads run tasks of different
+// compilations, so a task must not leave its level to the next one
+class DebugLevelScope {
+ public:
+    explicit DebugLevelScope(unsigned level) : prev_level_(g_debug_level) { g_debug_level = level; }
+    ~DebugLevelScope() { g_debug_level = prev_level_; }
+    DebugLevelScope(const DebugLevelScope&) = delete;
+    DebugLevelScope& operator=(const DebugLevelScope&) = delete;
+
+ private:
+    unsigned prev_level_;
+};
+
+// Writes already formatted text to the current output of the calling thread
+void writeOutput(std::string_view text);
+
+// Numbers of warnings and errors reported by the calling thread
+struct MessageCounts {
+    unsigned warnings = 0;
+    unsigned errors = 0;
+};
+MessageCounts getThreadMessageCounts();
 
 enum class MsgType : unsigned { kFatal = 0, kError, kWarning, kNote, kInfo, kDebug };
 constexpr MsgType operator+(MsgType type, unsigned level) {
@@ -1,17 +1,49 @@
 #pragma once
 
+#include <algorithm>
+#include <memory>
 #include <string_view>
 #include <vector>
 
-#define DAISY_ADD_PASS(pass_type) static daisy::pass_type g_pass_##pass_type
+#define DAISY_ADD_PASS(pass_type) \
+    static daisy::PassFactory g_pass_factory_##pass_type( \
+        []() -> std::unique_ptr<daisy::Pass> { return std::make_unique<daisy::pass_type>(); })
 
 namespace daisy {
 
+namespace ir {
+class FuncDefNode;
+}
+
 class Pass;
 struct CompilationContext;
 
 enum class PassResult { kSuccess = 0, kError, kFatalError };
 
+// Describes dependencies of a pass: analyses it requires to be valid before it runs, and analyses which stay valid
+// after it runs. Analysis passes implicitly preserve everything.
+class AnalysisUsage {
+ public:
+    AnalysisUsage& addRequired(std::string_view name) {
+        required_.push_back(name);
+        return *this;
+    }
+    AnalysisUsage& addPreserved(std::string_view name) {
+        preserved_.push_back(name);
+        return *this;
+    }
+    void setPreservesAll() { preserves_all_ = true; }
+    const std::vector<std::string_view>& getRequired() const { return required_; }
+    bool isPreserved(std::string_view name) const {
+        return preserves_all_ || std::find(preserved_.begin(), preserved_.end(), name) != preserved_.end();
+    }
+
+ private:
+    bool preserves_all_ = false;
+    std::vector<std::string_view> required_;
+    std::vector<std::string_view> preserved_;
+};
+
 class PassManager {
  public:
     static PassManager& getInstance();
@@ -20,26 +52,58 @@ class PassManager {
     PassResult run(CompilationContext& ctx);
 
  private:
-    std::vector<Pass*> passes_;
+    struct PassEntry {
+        std::unique_ptr<Pass> pass;
+        AnalysisUsage usage;
+        std::vector<const PassEntry*> required;
+    };
+
+    bool is_configured_ = false;
+    std::vector<PassEntry> passes_;  // in dependency order
+
+    PassResult runPass(const PassEntry& entry, CompilationContext& ctx);
+    PassResult ensureRequired(const PassEntry& entry, CompilationContext& ctx);
 };
 
 class Pass {
  public:
-    Pass() : next_avail_(first_avail_) { first_avail_ = this; }
     void enable() { is_enabled_ = true; }
     void disable() { is_enabled_ = false; }
     bool isEnabled() const { return is_enabled_; }
     virtual std::string_view getName() const = 0;
+    // Analysis passes do not modify IR, they only store their results to `CompilationContext`, so they are run at
+    // most once per context until a transform pass invalidates them; consumers of a failed analysis are not run
+    virtual bool isAnalysis() const { return false; }
+    virtual void getAnalysisUsage(AnalysisUsage& /*usage*/) const {}
     virtual void configure() = 0;
     virtual PassResult run(CompilationContext& ctx) = 0;
     virtual void cleanup() = 0;
     virtual ~Pass() = default;
 
  private:
-    friend class PassManager;
-    static Pass* first_avail_;
-    Pass* next_avail_;
     bool is_enabled_ = true;
 };
 
+// Runs over all defined functions of a translation unit. If the context has a thread pool, functions are processed
+// concurrently, each on the pass instance of the executing thread, and messages are printed in function order.
+// Module-level passes are barriers between function passes. Nested functions are processed as separate functions,
+// possibly concurrently with the enclosing one, so `runOnFunction` must not modify nested function definitions.
+// Note: per-function state must not outlive `runOnFunction`, because the same thread can process functions of
+// several translation units interleaved
+class FunctionPass : public Pass {
+ public:
+    virtual PassResult runOnFunction(CompilationContext& ctx, ir::FuncDefNode& func) = 0;
+    PassResult run(CompilationContext& ctx) final;
+    void cleanup() override {}
+};
+
+// Each `PassManager` instantiates its own set of passes, so passes are free to keep per-run state in members
+struct PassFactory {
+    using FuncType = std::unique_ptr<Pass> (*)();
+    explicit PassFactory(FuncType fn) : next_avail(first_avail), func(fn) { first_avail = this; }
+    static const PassFactory* first_avail;
+    const PassFactory* next_avail;
+    FuncType func;
+};
+
 }  // namespace daisy
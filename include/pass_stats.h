@@ -0,0 +1,103 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace daisy {
+
+enum class PassPhase : unsigned { kRun = 0, kCleanup };
+
+struct PassStats {
+    PassStats& operator+=(const PassStats& other);
+    unsigned count = 0;
+    double wall_time = 0;  // seconds
+    double cpu_time = 0;   // seconds, of the calling thread and its helper threads
+    std::uint64_t alloc_count = 0;
+    std::uint64_t alloc_bytes = 0;
+    std::int64_t rss_delta = 0;  // bytes, process-wide
+};
+
+// Aggregates pass statistics over all translation units of a compiler run. Measurement is performed only for
+// compilation contexts referring to a collector, otherwise `PassManager` does not touch clocks or allocation counters.
+// Note: allocation counting is enabled by the first collector and is never disabled, because other collectors can be
+// in use concurrently (e.g. by other compile server requests)
+class PassStatsCollector {
+ public:
+    PassStatsCollector();
+    PassStatsCollector(const PassStatsCollector&) = delete;
+    PassStatsCollector& operator=(const PassStatsCollector&) = delete;
+
+    void add(std::string_view pass_name, PassPhase phase, const PassStats& stats);
+    std::string makeTableReport() const;
+    std::string makeJsonReport() const;
+
+ private:
+    struct Entry {
+        std::string pass_name;
+        PassPhase phase;
+        PassStats stats;
+    };
+
+    mutable std::mutex mtx_;
+    std::vector<Entry> entries_;
+};
+
+// Measures the scope of the object and adds collected statistics to `collector` on destruction
+class PassStatsScope {
+ public:
+    PassStatsScope(PassStatsCollector& collector, std::string_view pass_name, PassPhase phase);
+    ~PassStatsScope();
+    PassStatsScope(const PassStatsScope&) = delete;
+    PassStatsScope& operator=(const PassStatsScope&) = delete;
+
+    // Returns the innermost scope measured on the calling thread, or `nullptr` if there is no one
+    static PassStatsScope* getCurrent();
+
+ private:
+    friend class PassStatsHelperScope;
+
+    struct Snapshot {
+        double wall_time;
+        double cpu_time;
+        std::uint64_t alloc_count;
+        std::uint64_t alloc_bytes;
+        std::int64_t rss;
+    };
+
+    PassStatsCollector& collector_;
+    std::string_view pass_name_;
+    PassPhase phase_;
+    Snapshot start_;
+    PassStatsScope* prev_;
+    std::mutex helper_mtx_;
+    PassStats helper_stats_;  // CPU time and allocations of helper threads
+
+    static Snapshot takeSnapshot();
+};
+
+// Measures CPU time and allocations of a helper thread doing the work of the pass measured by `parent` scope and
+// moves them to that scope on destruction. Note: these counters are per-thread, so they are not seen by the parent;
+// the work is subtracted from the scope measured on the helper thread itself, if any (e.g. a worker running tasks of
+// another translation unit while waiting). The helper scope must be destroyed before the parent one, `nullptr`
+// parent or the parent measured on the same thread disables measurement.
+class PassStatsHelperScope {
+ public:
+    explicit PassStatsHelperScope(PassStatsScope* parent);
+    ~PassStatsHelperScope();
+    PassStatsHelperScope(const PassStatsHelperScope&) = delete;
+    PassStatsHelperScope& operator=(const PassStatsHelperScope&) = delete;
+
+ private:
+    PassStatsScope* parent_;
+    PassStatsScope* own_;
+    PassStatsScope::Snapshot start_;
+};
+
+// Returns the number of allocations made by the calling thread since the first `PassStatsCollector` was created;
+// allocations are counted only if the compiler is built with `COUNT_ALLOCATIONS` option, otherwise it returns 0
+std::uint64_t getThreadAllocCount();
+
+}  // namespace daisy
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <cstdint>
+#include <string_view>
+
+namespace util {
+
+// 64-bit FNV-1a hash; unlike `std::hash` it is stable between runs and builds, so it can be stored on disk
+class fnv1a_hasher {
+ public:
+    static constexpr std::uint64_t kOffsetBasis = 0xcbf29ce484222325ull;
+    static constexpr std::uint64_t kPrime = 0x100000001b3ull;
+
+    constexpr fnv1a_hasher& update(std::string_view s) noexcept {
+        for (char ch : s) { h_ = (h_ ^ static_cast<std::uint8_t>(ch)) * kPrime; }
+        return *this;
+    }
+
+    // Hashes the length first, so sequences of strings can't be confused by moving a boundary
+    constexpr fnv1a_hasher& update_field(std::string_view s) noexcept {
+        std::uint64_t sz = s.size();
+        for (unsigned n = 0; n < 8; ++n, sz >>= 8) { h_ = (h_ ^ (sz & 0xff)) * kPrime; }
+        return update(s);
+    }
+
+    constexpr std::uint64_t value() const noexcept { return h_; }
+
+ private:
+    std::uint64_t h_ = kOffsetBasis;
+};
+
+constexpr std::uint64_t fnv1a_hash(std::string_view s) noexcept { return fnv1a_hasher{}.update(s).value(); }
+
+}  // namespace util
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <string_view>
+
+namespace util {
+
+struct keyword_entry {
+    std::string_view word;
+    int value = 0;  // must be nonzero
+};
+
+// Perfect hash table of a small constant set of nonempty words built at compile time. A word is hashed by its length
+// and its first and last characters only; hash multipliers are searched for at compile time until there are no
+// collisions, so a lookup is a single probe and at most one string comparison
+template<std::size_t N>
+class keyword_table {
+ public:
+    static constexpr std::size_t kTableSize = 2 * std::bit_ceil(N);
+
+    consteval explicit keyword_table(const std::array<keyword_entry, N>& words) {
+        for (mul_len_ = 1; mul_len_ < kMaxMultiplier; ++mul_len_) {
+            for (mul_last_ = 0; mul_last_ < kMaxMultiplier; ++mul_last_) {
+                if (try_build(words)) { return; }
+            }
+        }
+        throw "no perfect hash found for keywords";
+    }
+
+    // Returns the value of the word or 0 if `s` is not in the table
+    constexpr int find(std::string_view s) const noexcept {
+        if (s.empty()) { return 0; }
+        const keyword_entry& entry = table_[hash(s)];
+        return entry.word == s ? entry.value : 0;
+    }
+
+ private:
+    static constexpr unsigned kMaxMultiplier = 64;
+    std::array<keyword_entry, kTableSize> table_{};
+    unsigned mul_len_ = 1;
+    unsigned mul_last_ = 0;
+
+    constexpr std::size_t hash(std::string_view s) const noexcept {
+        return (s.size() * mul_len_ + static_cast<unsigned char>(s.front()) +
+                static_cast<unsigned char>(s.back()) * mul_last_) &
+               (kTableSize - 1);
+    }
+
+    constexpr bool try_build(const std::array<keyword_entry, N>& words) {
+        table_ = {};
+        for (const keyword_entry& word : words) {
+            keyword_entry& entry = table_[hash(word.word)];
+            if (!entry.word.empty()) { return false; }
+            entry = word;
+        }
+        return true;
+    }
+};
+
+}  // namespace util
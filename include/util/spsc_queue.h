@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace util {
+
+// Bounded lock-free queue of one producer thread and one consumer thread. Elements are constructed once and reused,
+// so their buffers survive: the producer fills the element returned by `back()` and publishes it by `push_back()`,
+// the consumer reads `front()` and releases it by `pop_front()`. `back()` waits while the queue is full, and
+// `front()` waits while it is empty
+template<typename Ty, std::size_t N>
+class spsc_queue {
+    static_assert(N != 0 && (N & (N - 1)) == 0, "queue size must be a power of 2");
+
+ public:
+    spsc_queue() = default;
+    spsc_queue(const spsc_queue&) = delete;
+    spsc_queue& operator=(const spsc_queue&) = delete;
+
+    // Producer side
+    Ty& back() {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        while (tail - cached_head_ == N) {
+            if ((cached_head_ = head_.load(std::memory_order_acquire)) + N == tail) {
+                head_.wait(cached_head_, std::memory_order_acquire);
+            }
+        }
+        return items_[tail & (N - 1)];
+    }
+    void push_back() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        tail_.notify_one();
+    }
+
+    // Consumer side
+    Ty& front() {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        while (head == cached_tail_) {
+            if ((cached_tail_ = tail_.load(std::memory_order_acquire)) == head) {
+                tail_.wait(head, std::memory_order_acquire);
+            }
+        }
+        return items_[head & (N - 1)];
+    }
+    void pop_front() {
+        head_.store(head_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        head_.notify_one();
+    }
+
+ private:
+    // Note: indices grow monotonically; each side keeps the last seen index of the other side in its own cache line
+    alignas(64) std::atomic<std::size_t> head_{0};
+    std::size_t cached_tail_ = 0;
+    alignas(64) std::atomic<std::size_t> tail_{0};
+    std::size_t cached_head_ = 0;
+    alignas(64) std::array<Ty, N> items_{};
+};
+
+}  // namespace util
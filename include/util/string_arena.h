@@ -0,0 +1,46 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+// Bump allocator of immutable strings: all strings are freed together with the arena, and stored strings are never
+// moved, so views to them stay valid during arena lifetime
+class string_arena {
+ public:
+    static constexpr std::size_t kBlockSize = 16384;
+
+    string_arena() = default;
+    string_arena(const string_arena&) = delete;
+    string_arena& operator=(const string_arena&) = delete;
+
+    // Returns uninitialized storage of `sz` characters
+    char* allocate(std::size_t sz) {
+        if (sz > kBlockSize / 4) { return blocks_.emplace_back(std::make_unique<char[]>(sz)).get(); }
+        if (sz > avail_size_) {
+            avail_ = blocks_.emplace_back(std::make_unique<char[]>(kBlockSize)).get();
+            avail_size_ = kBlockSize;
+        }
+        char* p = avail_;
+        avail_ += sz, avail_size_ -= sz;
+        return p;
+    }
+
+    std::string_view store(std::string_view s) {
+        if (s.empty()) { return {}; }
+        char* p = allocate(s.size());
+        std::copy(s.begin(), s.end(), p);
+        return std::string_view(p, s.size());
+    }
+
+ private:
+    std::vector<std::unique_ptr<char[]>> blocks_;
+    char* avail_ = nullptr;
+    std::size_t avail_size_ = 0;
+};
+
+}  // namespace util
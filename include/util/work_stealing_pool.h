@@ -0,0 +1,164 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace util {
+
+class work_stealing_pool {
+ public:
+    static constexpr unsigned kNotWorker = ~0u;
+
+    explicit work_stealing_pool(unsigned thread_count) : queues_(thread_count ? thread_count : 1) {
+        threads_.reserve(queues_.size());
+        for (unsigned n = 0; n < queues_.size(); ++n) { threads_.emplace_back([this, n] { worker_loop(n); }); }
+    }
+
+    ~work_stealing_pool() {
+        {
+            std::lock_guard lk(sleep_mtx_);
+            stop_ = true;
+        }
+        cv_.notify_all();
+        for (auto& thread : threads_) { thread.join(); }
+    }
+
+    work_stealing_pool(const work_stealing_pool&) = delete;
+    work_stealing_pool& operator=(const work_stealing_pool&) = delete;
+
+    unsigned size() const noexcept { return static_cast<unsigned>(queues_.size()); }
+
+    // Returns index of the calling worker thread or `kNotWorker` if called from outside of this pool
+    unsigned current_worker_index() const noexcept { return tls_pool_ == this ? tls_worker_index_ : kNotWorker; }
+
+    void submit(std::function<void()> task) {
+        unsigned n = current_worker_index();
+        if (n == kNotWorker) { n = next_queue_.fetch_add(1, std::memory_order_relaxed) % size(); }
+        {
+            std::lock_guard lk(queues_[n].mtx);
+            queues_[n].tasks.emplace_back(std::move(task));
+        }
+        queued_count_.fetch_add(1, std::memory_order_release);
+        notify(false);
+    }
+
+    // Runs `fn(i)` for every `i` in [0, count) and blocks until all calls are finished. Indices are claimed in
+    // increasing order by helper tasks and, if called from a worker thread, by the caller itself. While waiting for
+    // calls running on other threads, the caller does not pick up unrelated tasks, so a worker is never re-entered by
+    // e.g. another compilation, which would share its thread-local state. Nested calls never deadlock, because the
+    // caller waits only for calls which are already running.
+    // The first exception thrown by `fn` is rethrown to the caller.
+    template<typename Fn>
+    void parallel_for(std::size_t count, Fn fn) {
+        if (count == 0) { return; }
+
+        struct group_state {
+            group_state(std::size_t n, Fn& f) : count(n), remaining(n), fn(f) {}
+            const std::size_t count;
+            std::atomic<std::size_t> next_index{0};
+            std::atomic<std::size_t> remaining;
+            Fn& fn;  // Note: not called after all indices are claimed, so it can live on the caller's stack
+            std::mutex exception_mtx;
+            std::exception_ptr exception;
+        };
+
+        auto run_indices = [this](group_state& group) {
+            for (std::size_t i = 0; (i = group.next_index.fetch_add(1, std::memory_order_relaxed)) < group.count;) {
+                try {
+                    group.fn(i);
+                } catch (...) {
+                    std::lock_guard lk(group.exception_mtx);
+                    if (!group.exception) { group.exception = std::current_exception(); }
+                }
+                if (group.remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) { notify(true); }
+            }
+        };
+
+        // Note: helper tasks can start after the call is finished, so the group is shared with them
+        auto group = std::make_shared<group_state>(count, fn);
+        const bool is_worker = current_worker_index() != kNotWorker;
+        const std::size_t helper_count = std::min<std::size_t>(is_worker ? count - 1 : count, size());
+        for (std::size_t n = 0; n < helper_count; ++n) {
+            submit([group, run_indices] { run_indices(*group); });
+        }
+        if (is_worker) { run_indices(*group); }
+
+        {
+            std::unique_lock lk(sleep_mtx_);
+            cv_.wait(lk, [&group] { return group->remaining.load(std::memory_order_acquire) == 0; });
+        }
+
+        if (group->exception) { std::rethrow_exception(group->exception); }
+    }
+
+ private:
+    struct task_queue {
+        std::mutex mtx;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    std::vector<task_queue> queues_;
+    std::vector<std::thread> threads_;
+    std::atomic<std::size_t> queued_count_{0};
+    std::atomic<unsigned> next_queue_{0};
+    std::mutex sleep_mtx_;
+    std::condition_variable cv_;
+    bool stop_ = false;
+
+    static inline thread_local const work_stealing_pool* tls_pool_ = nullptr;
+    static inline thread_local unsigned tls_worker_index_ = kNotWorker;
+
+    void notify(bool all) {
+        { std::lock_guard lk(sleep_mtx_); }  // Prevents lost wake-ups of threads going to sleep
+        if (all) {
+            cv_.notify_all();
+        } else {
+            cv_.notify_one();
+        }
+    }
+
+    bool try_pop(unsigned n, bool from_back, std::function<void()>& task) {
+        auto& queue = queues_[n];
+        std::lock_guard lk(queue.mtx);
+        if (queue.tasks.empty()) { return false; }
+        if (from_back) {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        } else {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        }
+        return true;
+    }
+
+    bool try_run_one(unsigned self) {
+        std::function<void()> task;
+        // Own queue is processed in LIFO order, other queues are robbed in FIFO order
+        bool found = try_pop(self, true, task);
+        for (unsigned k = 1; !found && k < size(); ++k) { found = try_pop((self + k) % size(), false, task); }
+        if (!found) { return false; }
+        queued_count_.fetch_sub(1, std::memory_order_acq_rel);
+        task();
+        return true;
+    }
+
+    void worker_loop(unsigned self) {
+        tls_pool_ = this, tls_worker_index_ = self;
+        while (true) {
+            if (try_run_one(self)) { continue; }
+            std::unique_lock lk(sleep_mtx_);
+            cv_.wait(lk, [this] { return stop_ || queued_count_.load(std::memory_order_acquire); });
+            if (stop_ && !queued_count_.load(std::memory_order_acquire)) { return; }
+        }
+    }
+};
+
+}  // namespace util
@@ -0,0 +1,146 @@
+#include "build_cache.h"
+
+#include "ctx/ctx.h"
+
+#include "uxs/io/filebuf.h"
+
+#include <uxs/format.h>
+#include <charconv>
+#include <filesystem>
+#include <thread>
+#include <unordered_set>
+
+#if defined(_WIN32)
+#    include <process.h>
+#else
+#    include <unistd.h>
+#endif
+
+using namespace daisy;
+
+// Entry format:
+//   daisy-build-cache 2
+//   dep <content hash> <normalized path>
+//   ...
+//   missing <normalized path>
+//   ...
+//   result <pass result>
+//   output <size>
+//   <captured output>
+
+namespace {
+
+constexpr std::string_view kEntryHeader = "daisy-build-cache 2";
+
+unsigned long getProcessId() {
+#if defined(_WIN32)
+    return static_cast<unsigned long>(::_getpid());
+#else
+    return static_cast<unsigned long>(::getpid());
+#endif
+}
+
+bool readFile(const std::string& file_name, std::string& text) {
+    uxs::filebuf ifile(file_name.c_str(), "r");
+    if (!ifile) { return false; }
+    auto pos = ifile.seek(0, uxs::seekdir::end);
+    if (pos == uxs::iobuf::traits_type::npos()) { return false; }
+    text.resize(static_cast<std::size_t>(pos));
+    ifile.seek(0);
+    text.resize(ifile.read(std::span(text.data(), text.size())));
+    return true;
+}
+
+// Extracts the next line not including '\n'; returns `false` at the end of text
+bool getLine(std::string_view& text, std::string_view& line) {
+    if (text.empty()) { return false; }
+    auto pos = text.find('\n');
+    line = text.substr(0, pos);
+    text = pos != std::string_view::npos ? text.substr(pos + 1) : std::string_view();
+    return true;
+}
+
+template<typename Ty>
+bool parseNumber(std::string_view s, Ty& val, int base = 10) {
+    auto [p, ec] = std::from_chars(s.data(), s.data() + s.size(), val, base);
+    return ec == std::errc() && p == s.data() + s.size() && !s.empty();
+}
+
+bool consumePrefix(std::string_view& s, std::string_view prefix) {
+    if (s.substr(0, prefix.size()) != prefix) { return false; }
+    s = s.substr(prefix.size());
+    return true;
+}
+
+}  // namespace
+
+bool BuildCache::lookup(std::uint64_t key, PassResult& result, std::string& output,
+                        std::vector<std::string>* dependencies) const {
+    std::string entry;
+    if (!readFile(makeEntryPath(key), entry)) { return false; }
+    if (dependencies) { dependencies->clear(); }
+
+    std::string_view text(entry), line;
+    if (!getLine(text, line) || line != kEntryHeader) { return false; }
+
+    while (getLine(text, line)) {
+        if (consumePrefix(line, "dep ")) {
+            auto pos = line.find(' ');
+            if (pos == std::string_view::npos) { return false; }
+            std::uint64_t hash = 0;
+            if (!parseNumber(line.substr(0, pos), hash, 16)) { return false; }
+            auto source = SourceFileCache::getInstance().getFile(std::string(line.substr(pos + 1)));
+            if (!source || source->getContentHash() != hash) { return false; }
+            if (dependencies) { dependencies->emplace_back(line.substr(pos + 1)); }
+        } else if (consumePrefix(line, "missing ")) {
+            if (SourceFileCache::getInstance().getFile(std::string(line))) { return false; }
+        } else if (consumePrefix(line, "result ")) {
+            unsigned n = 0;
+            if (!parseNumber(line, n) || n > static_cast<unsigned>(PassResult::kFatalError)) { return false; }
+            result = static_cast<PassResult>(n);
+        } else if (consumePrefix(line, "output ")) {
+            std::size_t sz = 0;
+            if (!parseNumber(line, sz) || sz > text.size()) { return false; }
+            output.assign(text.substr(0, sz));
+            return true;
+        } else {
+            return false;
+        }
+    }
+    return false;
+}
+
+void BuildCache::store(std::uint64_t key, const CompilationContext& ctx, PassResult result,
+                       std::string_view output) const {
+    std::string entry(kEntryHeader);
+    entry += '\n';
+    for (std::string_view path : ctx.dependencies) {
+        const auto& file_info = ctx.input_files.find(std::string(path))->second;
+        uxs::basic_format(entry, "dep {:016x} {}\n", file_info->source->getContentHash(), path);
+    }
+    std::unordered_set<std::string_view> missing_files;
+    for (std::string_view path : ctx.missing_files) {
+        if (missing_files.insert(path).second) { uxs::basic_format(entry, "missing {}\n", path); }
+    }
+    uxs::basic_format(entry, "result {}\noutput {}\n", static_cast<unsigned>(result), output.size());
+    entry += output;
+
+    std::error_code ec;
+    std::filesystem::create_directories(dir_, ec);
+
+    // Note: the entry is written to a temporary file and renamed, so concurrent readers never see a partial entry
+    const std::string entry_path = makeEntryPath(key);
+    const std::string tmp_path = uxs::format("{}.{}.{}.tmp", entry_path, getProcessId(),
+                                             std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        uxs::filebuf ofile(tmp_path.c_str(), "w");
+        if (!ofile) { return; }
+        ofile.write(entry);
+    }
+    std::filesystem::rename(tmp_path, entry_path, ec);
+    if (ec) { std::filesystem::remove(tmp_path, ec); }
+}
+
+std::string BuildCache::makeEntryPath(std::uint64_t key) const {
+    return (std::filesystem::path(dir_) / uxs::format("{:016x}.entry", key)).generic_string();
+}
@@ -0,0 +1,116 @@
+#include "common/identifier.h"
+
+#include "util/hash.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <unordered_set>
+#include <vector>
+
+using namespace daisy;
+
+namespace {
+
+struct EntryHash {
+    std::size_t operator()(const Identifier::Entry& entry) const noexcept { return entry.hash; }
+};
+
+struct EntryEqual {
+    bool operator()(const Identifier::Entry& lhs, const Identifier::Entry& rhs) const noexcept {
+        return lhs.hash == rhs.hash && lhs.text == rhs.text;
+    }
+};
+
+// Note: the table is split into shards by hash, so concurrent compilations rarely contend for the same lock
+class IdentifierTable {
+ public:
+    static IdentifierTable& getInstance() {
+        static IdentifierTable instance;
+        return instance;
+    }
+
+    const Identifier::Entry* intern(std::string_view text) {
+        const Identifier::Entry key{static_cast<std::size_t>(util::fnv1a_hash(text)), text};
+        Shard& shard = shards_[key.hash >> (8 * sizeof(std::size_t) - kShardCountLog2)];
+        {
+            std::shared_lock lk(shard.mtx);
+            if (auto it = shard.entries.find(key); it != shard.entries.end()) { return &*it; }
+        }
+        std::lock_guard lk(shard.mtx);
+        if (auto it = shard.entries.find(key); it != shard.entries.end()) { return &*it; }
+        entry_count_.fetch_add(1, std::memory_order_relaxed);
+        // Note: elements of `std::unordered_set` are never moved, so entry pointers stay valid
+        return &*shard.entries.emplace(Identifier::Entry{key.hash, shard.store(text)}).first;
+    }
+
+    void addUser() {
+        std::lock_guard lk(users_mtx_);
+        ++user_count_;
+    }
+
+    void removeUser() {
+        std::lock_guard lk(users_mtx_);
+        // Note: no new user can appear while the lock is held, so the table is cleared when nobody refers to it
+        if (--user_count_ == 0 && entry_count_.load(std::memory_order_relaxed) > Identifier::kMaxTableSize) {
+            for (auto& shard : shards_) {
+                std::lock_guard shard_lk(shard.mtx);
+                shard.entries.clear(), shard.blocks.clear();
+                shard.avail = nullptr, shard.avail_size = 0;
+            }
+            entry_count_.store(0, std::memory_order_relaxed);
+            epoch_.fetch_add(1, std::memory_order_release);
+        }
+    }
+
+    std::uint64_t getEpoch() const noexcept { return epoch_.load(std::memory_order_acquire); }
+
+ private:
+    static constexpr unsigned kShardCountLog2 = 4;
+    static constexpr std::size_t kBlockSize = 16384;
+
+    struct Shard {
+        std::shared_mutex mtx;
+        std::unordered_set<Identifier::Entry, EntryHash, EntryEqual> entries;
+        std::vector<std::unique_ptr<char[]>> blocks;
+        char* avail = nullptr;
+        std::size_t avail_size = 0;
+
+        std::string_view store(std::string_view text) {
+            char* p = nullptr;
+            if (text.size() > kBlockSize / 4) {  // a long name gets its own block
+                p = blocks.emplace_back(std::make_unique<char[]>(text.size())).get();
+            } else {
+                if (text.size() > avail_size) {
+                    avail = blocks.emplace_back(std::make_unique<char[]>(kBlockSize)).get();
+                    avail_size = kBlockSize;
+                }
+                p = avail, avail += text.size(), avail_size -= text.size();
+            }
+            std::copy(text.begin(), text.end(), p);
+            return std::string_view(p, text.size());
+        }
+    };
+
+    std::array<Shard, 1 << kShardCountLog2> shards_;
+    std::atomic<std::size_t> entry_count_{0};
+    std::atomic<std::uint64_t> epoch_{0};
+    std::mutex users_mtx_;
+    unsigned user_count_ = 0;
+};
+
+}  // namespace
+
+/*static*/ const Identifier::Entry* Identifier::intern(std::string_view text) {
+    if (text.empty()) { return nullptr; }
+    return IdentifierTable::getInstance().intern(text);
+}
+
+Identifier::TableUse::TableUse() { IdentifierTable::getInstance().addUser(); }
+
+Identifier::TableUse::~TableUse() { IdentifierTable::getInstance().removeUser(); }
+
+/*static*/ std::uint64_t Identifier::getTableEpoch() noexcept { return IdentifierTable::getInstance().getEpoch(); }
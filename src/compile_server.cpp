@@ -0,0 +1,234 @@
+#include "compile_server.h"
+
+#include "ctx/include_cache.h"
+#include "driver.h"
+#include "logger.h"
+#include "util/work_stealing_pool.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <signal.h>
+#    include <sys/socket.h>
+#    include <sys/stat.h>
+#    include <sys/un.h>
+#    include <unistd.h>
+#    define DAISY_HAS_COMPILE_SERVER 1
+#endif
+
+using namespace daisy;
+
+#if defined(DAISY_HAS_COMPILE_SERVER)
+
+namespace {
+
+// Request: working directory, argument count, arguments; response: exit code, output, messages.
+// Strings are sent as 32-bit length followed by characters, integers - in host byte order.
+// Note: request sizes are limited, so a malformed request cannot make the server allocate gigabytes
+
+constexpr std::uint32_t kMaxArgCount = 65536;
+constexpr std::uint32_t kMaxArgSize = 1024 * 1024;
+
+bool sendAll(int fd, const void* data, std::size_t sz) {
+    const char* p = static_cast<const char*>(data);
+    while (sz) {
+        ssize_t n = ::send(fd, p, sz, 0);
+        if (n <= 0) { return false; }
+        p += n, sz -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool recvAll(int fd, void* data, std::size_t sz) {
+    char* p = static_cast<char*>(data);
+    while (sz) {
+        ssize_t n = ::recv(fd, p, sz, 0);
+        if (n <= 0) { return false; }
+        p += n, sz -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+bool sendUInt32(int fd, std::uint32_t v) { return sendAll(fd, &v, sizeof(v)); }
+bool recvUInt32(int fd, std::uint32_t& v) { return recvAll(fd, &v, sizeof(v)); }
+
+bool sendString(int fd, std::string_view s) {
+    return sendUInt32(fd, static_cast<std::uint32_t>(s.size())) && sendAll(fd, s.data(), s.size());
+}
+
+bool recvString(int fd, std::string& s, std::uint32_t max_size = UINT32_MAX) {
+    std::uint32_t sz = 0;
+    if (!recvUInt32(fd, sz) || sz > max_size) { return false; }
+    s.resize(sz);
+    return recvAll(fd, s.data(), sz);
+}
+
+bool makeSocketAddress(std::string_view socket_path, sockaddr_un& addr) {
+    std::memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if (socket_path.size() >= sizeof(addr.sun_path)) { return false; }
+    std::memcpy(addr.sun_path, socket_path.data(), socket_path.size());
+    return true;
+}
+
+// Note: the server compiles arbitrary files on behalf of its clients, so only the user who runs it is served
+bool isPeerTrusted(int fd, uid_t& peer_uid) {
+#    if defined(SO_PEERCRED)
+    ucred cred{};
+    socklen_t len = sizeof(cred);
+    if (::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) != 0) { return false; }
+    peer_uid = cred.uid;
+#    else   // defined(SO_PEERCRED)
+    gid_t peer_gid = 0;
+    if (::getpeereid(fd, &peer_uid, &peer_gid) != 0) { return false; }
+#    endif  // defined(SO_PEERCRED)
+    return peer_uid == ::geteuid();
+}
+
+class FileDescriptor {
+ public:
+    explicit FileDescriptor(int fd) : fd_(fd) {}
+    ~FileDescriptor() {
+        if (fd_ >= 0) { ::close(fd_); }
+    }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    int get() const { return fd_; }
+
+ private:
+    int fd_;
+};
+
+void serveRequest(int fd, util::work_stealing_pool& pool, unsigned debug_level) {
+    FileDescriptor conn(fd);
+
+    std::uint32_t argc = 0;
+    std::string working_dir;
+    if (!recvString(fd, working_dir, kMaxArgSize) || !recvUInt32(fd, argc) || argc == 0 || argc > kMaxArgCount) {
+        return;
+    }
+    std::vector<std::string> args(argc);
+    for (auto& arg : args) {
+        if (!recvString(fd, arg, kMaxArgSize)) { return; }
+    }
+
+    std::vector<char*> argv;
+    argv.reserve(args.size());
+    for (auto& arg : args) { argv.push_back(arg.data()); }
+
+    DriverEnvironment env;
+    env.working_dir = std::move(working_dir);
+    env.pool = &pool;
+    env.is_server_request = true;
+
+    // Note: include resolution results can be outdated since previous request, so they are revalidated
+    IncludeCache::getInstance().startGeneration();
+
+    // Note: debug level is per-thread, so the value left by previous request is reset
+    logger::g_debug_level = debug_level;
+
+    int ret_code = 0;
+    std::string out, log;
+    {
+        logger::OutputCapture capture(log);
+        ret_code = runCompiler(static_cast<int>(argv.size()), argv.data(), env, out);
+    }
+
+    // Note: nothing can be done if the client has gone
+    if (sendUInt32(fd, static_cast<std::uint32_t>(ret_code)) && sendString(fd, out)) { sendString(fd, log); }
+}
+
+}  // namespace
+
+int daisy::runCompileServer(std::string_view socket_path, unsigned thread_count) {
+    sockaddr_un addr;
+    if (!makeSocketAddress(socket_path, addr)) {
+        logger::fatal().println("too long compile server socket path `{}`", socket_path);
+        return -1;
+    }
+
+    // Note: a client disconnected in the middle of the response must not terminate the server
+    ::signal(SIGPIPE, SIG_IGN);
+
+    FileDescriptor listener(::socket(AF_UNIX, SOCK_STREAM, 0));
+    if (listener.get() < 0) {
+        logger::fatal().println("could not create compile server socket");
+        return -1;
+    }
+
+    ::unlink(addr.sun_path);  // remove the socket left by a previous server
+
+    // Note: the socket is created accessible only by the owner, the mask is restored before any thread is started
+    const mode_t prev_mask = ::umask(0177);
+    const bool is_bound = ::bind(listener.get(), reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) == 0;
+    ::umask(prev_mask);
+    if (!is_bound || ::listen(listener.get(), SOMAXCONN) != 0) {
+        logger::fatal().println("could not listen on compile server socket `{}`", socket_path);
+        return -1;
+    }
+
+    logger::info().println("compile server is listening on `{}`", socket_path);
+
+    util::work_stealing_pool pool(thread_count);
+    const unsigned debug_level = logger::g_debug_level;
+    while (true) {
+        int fd = ::accept(listener.get(), nullptr, nullptr);
+        if (fd < 0) {
+            if (errno == EINTR) { continue; }
+            logger::fatal().println("could not accept compile server connection");
+            return -1;
+        }
+        uid_t peer_uid = 0;
+        if (!isPeerTrusted(fd, peer_uid)) {
+            logger::warning().println("rejected compile server connection of user {}", peer_uid);
+            ::close(fd);
+            continue;
+        }
+        pool.submit([fd, &pool, debug_level] { serveRequest(fd, pool, debug_level); });
+    }
+}
+
+bool daisy::forwardToCompileServer(std::string_view socket_path, int argc, char** argv,
+                                   const std::string& working_dir, int& ret_code, std::string& out) {
+    sockaddr_un addr;
+    if (!makeSocketAddress(socket_path, addr)) { return false; }
+
+    FileDescriptor conn(::socket(AF_UNIX, SOCK_STREAM, 0));
+    if (conn.get() < 0 || ::connect(conn.get(), reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        return false;
+    }
+
+    ::signal(SIGPIPE, SIG_IGN);
+
+    bool ok = sendString(conn.get(), working_dir) && sendUInt32(conn.get(), static_cast<std::uint32_t>(argc));
+    for (int i = 0; ok && i < argc; ++i) { ok = sendString(conn.get(), argv[i]); }
+
+    std::uint32_t server_ret_code = 0;
+    std::string server_out, server_log;
+    if (!ok || !recvUInt32(conn.get(), server_ret_code) || !recvString(conn.get(), server_out) ||
+        !recvString(conn.get(), server_log)) {
+        return false;
+    }
+
+    ret_code = static_cast<int>(server_ret_code);
+    out += server_out;
+    logger::writeOutput(server_log);
+    return true;
+}
+
+#else  // defined(DAISY_HAS_COMPILE_SERVER)
+
+int daisy::runCompileServer(std::string_view /*socket_path*/, unsigned /*thread_count*/) {
+    logger::fatal().println("compile server is not supported on this platform");
+    return -1;
+}
+
+bool daisy::forwardToCompileServer(std::string_view /*socket_path*/, int /*argc*/, char** /*argv*/,
+                                   const std::string& /*working_dir*/, int& /*ret_code*/, std::string& /*out*/) {
+    return false;
+}
+
+#endif  // defined(DAISY_HAS_COMPILE_SERVER)
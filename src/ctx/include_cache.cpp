@@ -0,0 +1,70 @@
+#include "ctx/include_cache.h"
+
+#include <algorithm>
+#include <filesystem>
+
+using namespace daisy;
+
+/*static*/ IncludeCache& IncludeCache::getInstance() {
+    static IncludeCache cache;
+    return cache;
+}
+
+/*static*/ std::string IncludeCache::makeKey(std::string_view working_dir, std::string_view including_dir,
+                                             const std::vector<std::string_view>& include_paths,
+                                             std::string_view file_name) {
+    std::string key;
+    key.reserve(256);
+    key.append(file_name).append(1, '\0').append(including_dir).append(1, '\0').append(working_dir);
+    for (std::string_view path : include_paths) { key.append(1, '\0').append(path); }
+    return key;
+}
+
+std::shared_ptr<const IncludeCache::Entry> IncludeCache::find(const std::string& key) {
+    std::shared_ptr<CachedEntry> cached;
+    {
+        std::shared_lock lk(mtx_);
+        auto it = resolved_.find(key);
+        if (it == resolved_.end()) { return nullptr; }
+        cached = it->second;
+    }
+    cached->last_use.store(use_count_.fetch_add(1, std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+    const std::uint64_t generation = generation_.load(std::memory_order_relaxed);
+    if (cached->generation.load(std::memory_order_acquire) != generation) {
+        for (const auto& path : cached->entry.missing_paths) {
+            std::error_code ec;
+            const auto type = std::filesystem::status(path, ec).type();
+            if (ec || type == std::filesystem::file_type::not_found || type == std::filesystem::file_type::directory) {
+                continue;
+            }
+            std::unique_lock lk(mtx_);
+            auto it = resolved_.find(key);
+            if (it != resolved_.end() && it->second == cached) { resolved_.erase(it); }
+            return nullptr;
+        }
+        cached->generation.store(generation, std::memory_order_release);
+    }
+
+    return std::shared_ptr<const Entry>(cached, &cached->entry);
+}
+
+void IncludeCache::add(std::string key, Entry entry) {
+    auto cached = std::make_shared<CachedEntry>(std::move(entry), generation_.load(std::memory_order_relaxed),
+                                                use_count_.fetch_add(1, std::memory_order_relaxed) + 1);
+    std::unique_lock lk(mtx_);
+    resolved_.insert_or_assign(std::move(key), std::move(cached));
+    if (resolved_.size() > kMaxEntryCount) { evictEntries(); }
+}
+
+void IncludeCache::evictEntries() {
+    // Note: the older half of results is evicted at once, as `SourceFileCache` evicts paths
+    std::vector<std::uint64_t> last_uses;
+    last_uses.reserve(resolved_.size());
+    for (const auto& item : resolved_) { last_uses.push_back(item.second->last_use.load(std::memory_order_relaxed)); }
+    auto median = last_uses.begin() + last_uses.size() / 2;
+    std::nth_element(last_uses.begin(), median, last_uses.end());
+    std::erase_if(resolved_, [threshold = *median](const auto& item) {
+        return item.second->last_use.load(std::memory_order_relaxed) < threshold;
+    });
+}
@@ -0,0 +1,94 @@
+#include "ctx/include_prefetcher.h"
+
+#include "ctx/source_file_cache.h"
+#include "util/work_stealing_pool.h"
+
+#include <cstring>
+#include <filesystem>
+
+using namespace daisy;
+
+namespace {
+
+bool isBlank(char ch) { return ch == ' ' || ch == '\t'; }
+
+const char* skipBlanks(const char* p, const char* last) {
+    while (p != last && isBlank(*p)) { ++p; }
+    return p;
+}
+
+}  // namespace
+
+IncludePrefetcher::IncludePrefetcher(util::work_stealing_pool& pool, std::string working_dir,
+                                     const std::vector<std::string_view>& include_paths)
+    : pool_(pool), working_dir_(std::move(working_dir)), include_paths_(include_paths.begin(), include_paths.end()) {}
+
+void IncludePrefetcher::prefetchIncludes(const std::string& normal_path, std::shared_ptr<const SourceFile> file) {
+    {
+        std::lock_guard lk(mtx_);
+        visited_.insert(normal_path);
+    }
+    // Note: streamed files are not scanned, that would make the whole file resident
+    if (file->isStreamed()) { return; }
+    pool_.submit([self = weak_from_this(), normal_path, file = std::move(file)] {
+        if (auto prefetcher = self.lock()) { prefetcher->scanFile(normal_path, *file); }
+    });
+}
+
+/*static*/ std::vector<std::string_view> IncludePrefetcher::scanIncludes(std::string_view text) {
+    // Note: it is a cheap line-based scan, so line continuations and comments before `#` are not recognized
+    std::vector<std::string_view> file_names;
+    const char* first = text.data();
+    const char* last = text.data() + text.size();
+    for (const char* p = first; (p = static_cast<const char*>(std::memchr(p, '#', last - p))); ++p) {
+        const char* line_first = p;
+        while (line_first != first && isBlank(*(line_first - 1))) { --line_first; }
+        if (line_first != first && *(line_first - 1) != '\n') { continue; }
+
+        const char* directive = skipBlanks(p + 1, last);
+        if (static_cast<std::size_t>(last - directive) < 7 || std::memcmp(directive, "include", 7) != 0) { continue; }
+        const char* name_first = skipBlanks(directive + 7, last);
+        if (name_first == last || *name_first != '\"') { continue; }
+        const char* name_last = ++name_first;
+        while (name_last != last && *name_last != '\"' && *name_last != '\n' && *name_last != '\\') { ++name_last; }
+        if (name_last == last || *name_last != '\"' || name_last == name_first) { continue; }
+        file_names.emplace_back(name_first, name_last - name_first);
+        p = name_last;
+    }
+    return file_names;
+}
+
+void IncludePrefetcher::scanFile(const std::string& normal_path, const SourceFile& file) {
+    const std::string including_dir = std::filesystem::path(normal_path).parent_path().generic_string();
+    for (std::string_view file_name : scanIncludes(file.getContent())) {
+        pool_.submit([self = weak_from_this(), including_dir, file_name = std::string(file_name)] {
+            if (auto prefetcher = self.lock()) { prefetcher->prefetchFile(including_dir, file_name); }
+        });
+    }
+}
+
+void IncludePrefetcher::prefetchFile(const std::string& including_dir, std::string_view file_name) {
+    auto try_path = [this](const std::filesystem::path& path) {
+        std::string normal_path = path.lexically_normal().generic_string();
+        {
+            std::lock_guard lk(mtx_);
+            if (!visited_.insert(normal_path).second) { return true; }
+        }
+        auto source = SourceFileCache::getInstance().getFile(normal_path);
+        if (!source) {
+            std::lock_guard lk(mtx_);
+            visited_.erase(normal_path);
+            return false;
+        }
+        prefetchIncludes(normal_path, std::move(source));
+        return true;
+    };
+
+    // Search order is the same as of `#include` directive
+    if (try_path(std::filesystem::path(including_dir) / file_name)) { return; }
+    for (const auto& include_path : include_paths_) {
+        std::filesystem::path path(include_path);
+        if (path.is_relative()) { path = std::filesystem::path(working_dir_) / path; }
+        if (try_path(path / file_name)) { return; }
+    }
+}
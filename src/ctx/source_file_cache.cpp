@@ -0,0 +1,334 @@
+#include "ctx/source_file_cache.h"
+
+#include "ctx/lexeme_cache.h"
+#include "util/hash.h"
+
+#include "uxs/io/filebuf.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <filesystem>
+#include <limits>
+
+#if defined(__SSE2__)
+#    include <emmintrin.h>
+#    define DAISY_HAS_SSE2 1
+#endif
+
+#if defined(__unix__) || defined(__APPLE__)
+#    include <cerrno>
+#    include <fcntl.h>
+#    include <sys/mman.h>
+#    include <sys/stat.h>
+#    include <unistd.h>
+#    define DAISY_HAS_POSIX_FILE_API 1
+#endif
+
+using namespace daisy;
+
+namespace {
+
+// Returns the position after the `n`-th '\n' or `last` if there are fewer lines; `n` is decreased by the number of
+// skipped lines
+const char* skipLines(const char* first, const char* last, std::size_t& n) {
+    const char* p = first;
+#if defined(DAISY_HAS_SSE2)
+    const __m128i nl = _mm_set1_epi8('\n');
+    for (; last - p >= 16; p += 16) {
+        unsigned mask = static_cast<unsigned>(
+            _mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)), nl)));
+        const std::size_t count = static_cast<std::size_t>(__builtin_popcount(mask));
+        if (count < n) {
+            n -= count;
+            continue;
+        }
+        while (--n) { mask &= mask - 1; }
+        return p + __builtin_ctz(mask) + 1;
+    }
+#endif  // defined(DAISY_HAS_SSE2)
+    for (; n && (p = static_cast<const char*>(std::memchr(p, '\n', last - p))); --n) { ++p; }
+    return p ? p : last;
+}
+
+struct FileStatus {
+    enum class Type { kNotFound = 0, kRegular, kDirectory, kOther };
+    Type type = Type::kNotFound;
+    std::int64_t mtime = 0;
+    std::uint64_t size = 0;
+    FileId id;
+};
+
+FileStatus getFileStatus(const std::string& normal_path) {
+    FileStatus status;
+#if defined(DAISY_HAS_POSIX_FILE_API)
+    struct stat st {};
+    if (::stat(normal_path.c_str(), &st) != 0) { return status; }
+    status.type = S_ISREG(st.st_mode) ? FileStatus::Type::kRegular :
+                  S_ISDIR(st.st_mode) ? FileStatus::Type::kDirectory :
+                                        FileStatus::Type::kOther;
+#    if defined(__APPLE__)
+    const auto& mtime = st.st_mtimespec;
+#    else
+    const auto& mtime = st.st_mtim;
+#    endif
+    status.mtime = static_cast<std::int64_t>(mtime.tv_sec) * 1000000000 + mtime.tv_nsec;
+    status.size = static_cast<std::uint64_t>(st.st_size);
+    status.id = FileId{static_cast<std::uint64_t>(st.st_dev), static_cast<std::uint64_t>(st.st_ino)};
+#else   // defined(DAISY_HAS_POSIX_FILE_API)
+    std::error_code ec;
+    const auto type = std::filesystem::status(normal_path, ec).type();
+    if (ec || type == std::filesystem::file_type::not_found) { return status; }
+    status.type = type == std::filesystem::file_type::regular   ? FileStatus::Type::kRegular :
+                  type == std::filesystem::file_type::directory ? FileStatus::Type::kDirectory :
+                                                                  FileStatus::Type::kOther;
+    if (status.type == FileStatus::Type::kRegular) {
+        status.mtime = static_cast<std::int64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::filesystem::last_write_time(normal_path, ec).time_since_epoch())
+                .count());
+        status.size = static_cast<std::uint64_t>(std::filesystem::file_size(normal_path, ec));
+    }
+    // Note: file identity is not available, so the normalized path is used instead
+    status.id = FileId{0, util::fnv1a_hash(normal_path)};
+#endif  // defined(DAISY_HAS_POSIX_FILE_API)
+    return status;
+}
+
+// Memory used by lexeme caches of all files
+std::atomic<std::size_t> g_lexeme_cache_size{0};
+
+// Note: size of pipes is unknown, so files which can't be mapped are read till the end in chunks
+const std::size_t kReadChunkSize = 0x10000;
+
+#if defined(DAISY_HAS_POSIX_FILE_API)
+bool mapFile(int fd, SourceFile& file) {
+    struct stat st {};
+    // Note: empty files can't be mapped, and pipes are read by the fallback path
+    if (::fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_size <= 0) { return false; }
+    void* mapping = ::mmap(nullptr, static_cast<std::size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) { return false; }
+
+    file.mapping = mapping, file.mapping_size = static_cast<std::size_t>(st.st_size);
+    file.text = static_cast<const char*>(mapping), file.text_size = file.mapping_size;
+    return true;
+}
+
+bool readFile(int fd, SourceFile& file) {
+    std::size_t n_read = 0;
+    while (true) {
+        file.buffer.resize(n_read + kReadChunkSize);
+        const ssize_t n = ::read(fd, file.buffer.data() + n_read, kReadChunkSize);
+        if (n == 0) { break; }
+        if (n < 0) {
+            if (errno == EINTR) { continue; }
+            return false;
+        }
+        n_read += static_cast<std::size_t>(n);
+    }
+
+    file.buffer.resize(n_read);
+    file.text = file.buffer.data(), file.text_size = n_read;
+    return true;
+}
+#else   // defined(DAISY_HAS_POSIX_FILE_API)
+bool readFile(const std::string& normal_path, SourceFile& file) {
+    uxs::filebuf ifile(normal_path.c_str(), "r");
+    if (!ifile) { return false; }
+
+    std::size_t n_read = 0;
+    do {
+        file.buffer.resize(n_read + kReadChunkSize);
+        n_read += ifile.read(std::span(file.buffer.data() + n_read, kReadChunkSize));
+    } while (n_read == file.buffer.size());
+
+    file.buffer.resize(n_read);
+    file.text = file.buffer.data(), file.text_size = n_read;
+    return true;
+}
+#endif  // defined(DAISY_HAS_POSIX_FILE_API)
+
+}  // namespace
+
+SourceFile::~SourceFile() {
+#if defined(DAISY_HAS_POSIX_FILE_API)
+    if (mapping) { ::munmap(mapping, mapping_size); }
+#endif
+    if (const LexemeCache* cache = lexeme_cache.load(std::memory_order_relaxed)) {
+        g_lexeme_cache_size.fetch_sub(cache->getMemorySize(), std::memory_order_relaxed);
+        delete cache;
+    }
+}
+
+void SourceFile::publishLexemeCache(std::unique_ptr<LexemeCache> cache) const {
+    if (lexeme_cache.load(std::memory_order_relaxed)) { return; }
+    // Note: the cache is kept for the life of the file, so spare capacity is released
+    cache->lexemes.shrink_to_fit(), cache->ids.shrink_to_fit();
+    cache->int_consts.shrink_to_fit(), cache->float_consts.shrink_to_fit();
+    const std::size_t size = cache->getMemorySize();
+    if (g_lexeme_cache_size.fetch_add(size, std::memory_order_relaxed) + size > LexemeCache::kMaxTotalSize) {
+        g_lexeme_cache_size.fetch_sub(size, std::memory_order_relaxed);
+        return;
+    }
+    const LexemeCache* expected = nullptr;
+    if (lexeme_cache.compare_exchange_strong(expected, cache.get(), std::memory_order_release,
+                                             std::memory_order_relaxed)) {
+        cache.release();
+    } else {
+        g_lexeme_cache_size.fetch_sub(size, std::memory_order_relaxed);
+    }
+}
+
+void SourceFile::releasePages(const char* first, const char* last) const {
+#if defined(DAISY_HAS_POSIX_FILE_API)
+    if (!mapping) { return; }
+    static const std::size_t page_size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const char* mapping_first = static_cast<const char*>(mapping);
+    // Note: only whole pages inside of the range are released
+    std::size_t offset_first = (static_cast<std::size_t>(first - mapping_first) + page_size - 1) & ~(page_size - 1);
+    std::size_t offset_last = static_cast<std::size_t>(last - mapping_first) & ~(page_size - 1);
+    if (offset_first >= offset_last) { return; }
+    ::madvise(const_cast<char*>(mapping_first) + offset_first, offset_last - offset_first, MADV_DONTNEED);
+#else   // defined(DAISY_HAS_POSIX_FILE_API)
+    (void)first, (void)last;
+#endif  // defined(DAISY_HAS_POSIX_FILE_API)
+}
+
+std::uint64_t SourceFile::getContentHash() const {
+    std::call_once(content_hash_once, [this] { content_hash = util::fnv1a_hash(getContent()); });
+    return content_hash;
+}
+
+std::string_view SourceFile::getLine(unsigned ln) const {
+    // Note: 32-bit offsets halve the index, 64-bit ones are needed only for files larger than 4 GiB
+    std::lock_guard lk(line_index_mtx);
+    return text_size > std::numeric_limits<std::uint32_t>::max() ? getIndexedLine(line_offsets64, ln) :
+                                                                   getIndexedLine(line_offsets, ln);
+}
+
+template<typename Offset>
+std::string_view SourceFile::getIndexedLine(std::vector<Offset>& offsets, unsigned ln) const {
+    // Only every `kLineIndexStep`-th line start is indexed, so the index stays small; it is extended up to the
+    // requested line, which diagnostics usually report at positions the lexer has already passed
+    assert(ln > 0);
+    const char* last = text + text_size;
+    if (offsets.empty()) { offsets.push_back(0); }
+    const char* release_pos = text + offsets.back();
+    while ((ln - 1) / kLineIndexStep >= offsets.size()) {
+        std::size_t n = kLineIndexStep;
+        const char* p = skipLines(text + offsets.back(), last, n);
+        assert(n == 0);
+        offsets.push_back(static_cast<Offset>(p - text));
+        // Note: pages of a streamed file are released behind the scan, as the lexer does
+        if (isStreamed() && static_cast<std::size_t>(p - release_pos) >= 2 * kStreamingWindow) {
+            releasePages(release_pos, p - kStreamingWindow);
+            release_pos = p - kStreamingWindow;
+        }
+    }
+    std::size_t n = (ln - 1) % kLineIndexStep;
+    const char* first = text + offsets[(ln - 1) / kLineIndexStep];
+    if (n) { first = skipLines(first, last, n); }
+    assert(n == 0);
+    // Note: the text ends at the first '\0'
+    return std::string_view(first, std::find_if(first, last, [](char ch) { return ch == '\n' || !ch; }) - first);
+}
+
+/*static*/ SourceFileCache& SourceFileCache::getInstance() {
+    static SourceFileCache cache;
+    return cache;
+}
+
+std::shared_ptr<const SourceFile> SourceFileCache::getFile(const std::string& normal_path, FileId* file_id) {
+    const FileStatus status = getFileStatus(normal_path);
+    if (status.type == FileStatus::Type::kNotFound || status.type == FileStatus::Type::kDirectory) { return nullptr; }
+    if (file_id) { *file_id = status.id; }
+
+    // Note: contents of pipes and devices can't be validated, so they are never cached
+    if (status.type != FileStatus::Type::kRegular) { return loadFile(normal_path); }
+
+    std::promise<std::shared_ptr<const SourceFile>> loaded;
+    {
+        std::unique_lock lk(mtx_);
+        auto it = by_path_.find(normal_path);
+        if (it != by_path_.end() && it->second.mtime == status.mtime && it->second.file_size == status.size) {
+            it->second.last_use = ++use_count_;
+            return it->second.file;
+        }
+        // Note: a file which is being loaded by another thread, e.g. by the include prefetcher, is waited for
+        if (auto loading_it = loading_.find(normal_path); loading_it != loading_.end()) {
+            auto pending = loading_it->second;
+            lk.unlock();
+            return pending.get();
+        }
+        loading_.emplace(normal_path, loaded.get_future().share());
+    }
+
+    // Note: the file is loaded without holding the lock, loads of equal files by different paths are merged below
+    std::shared_ptr<const SourceFile> file;
+    try {
+        file = loadFile(normal_path);
+    } catch (...) {
+        loaded.set_exception(std::current_exception());
+        std::lock_guard lk(mtx_);
+        loading_.erase(normal_path);
+        throw;
+    }
+
+    std::lock_guard lk(mtx_);
+    loading_.erase(normal_path);
+    if (!file) {
+        loaded.set_value(nullptr);
+        return nullptr;
+    }
+
+    const std::string_view content = file->getContent();
+    if (!file->isStreamed()) {
+        auto [first, last] = by_size_.equal_range(content.size());
+        while (first != last) {
+            if (auto other = first->second.lock()) {
+                if (other->getContent() == content) {
+                    file = std::move(other);
+                    break;
+                }
+                ++first;
+            } else {
+                first = by_size_.erase(first);
+            }
+        }
+        if (first == last) { by_size_.emplace(content.size(), file); }
+    }
+
+    by_path_[normal_path] = PathEntry{status.mtime, status.size, ++use_count_, file};
+    if (by_path_.size() > kMaxPathCount) { evictPaths(); }
+    loaded.set_value(file);
+    return file;
+}
+
+void SourceFileCache::evictPaths() {
+    // Note: the older half of paths is evicted at once, so eviction cost is amortized over insertions; evicted files
+    // stay alive while compilation contexts use them
+    std::vector<std::uint64_t> last_uses;
+    last_uses.reserve(by_path_.size());
+    for (const auto& [path, entry] : by_path_) { last_uses.push_back(entry.last_use); }
+    auto median = last_uses.begin() + last_uses.size() / 2;
+    std::nth_element(last_uses.begin(), median, last_uses.end());
+    std::erase_if(by_path_, [threshold = *median](const auto& item) { return item.second.last_use < threshold; });
+    std::erase_if(by_size_, [](const auto& item) { return item.second.expired(); });
+}
+
+/*static*/ std::unique_ptr<SourceFile> SourceFileCache::loadFile(const std::string& normal_path) {
+    auto file = std::make_unique<SourceFile>();
+#if defined(DAISY_HAS_POSIX_FILE_API)
+    // Note: the file is opened only once, so input of a pipe or a device is not lost by reopening it
+    const int fd = ::open(normal_path.c_str(), O_RDONLY);
+    if (fd < 0) { return nullptr; }
+    const bool is_loaded = mapFile(fd, *file) || readFile(fd, *file);
+    ::close(fd);  // the mapping stays valid after closing
+    if (!is_loaded) { return nullptr; }
+#else   // defined(DAISY_HAS_POSIX_FILE_API)
+    if (!readFile(normal_path, *file)) { return nullptr; }
+#endif  // defined(DAISY_HAS_POSIX_FILE_API)
+
+    if (file->isStreamed()) { file->releasePages(file->text, file->text + file->text_size); }
+    return file;
+}
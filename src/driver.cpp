@@ -0,0 +1,389 @@
+#include "driver.h"
+
+#include "build_cache.h"
+#include "compile_server.h"
+#include "ctx/ctx.h"
+#include "ctx/include_prefetcher.h"
+#include "logger.h"
+#include "pass_manager.h"
+#include "pass_stats.h"
+#include "passes/daisy_parser_pass/daisy_parser_pass.h"
+#include "util/hash.h"
+#include "util/work_stealing_pool.h"
+
+#include "uxs/cli/parser.h"
+#include "uxs/io/filebuf.h"
+
+#include <uxs/algorithm.h>
+
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#define XSTR(s) STR(s)
+#define STR(s)  #s
+
+using namespace daisy;
+
+namespace {
+
+struct CompilationOptions {
+    std::string working_dir;
+    util::work_stealing_pool* pool = nullptr;
+    const BuildCache* cache = nullptr;
+    util::work_stealing_pool* io_pool = nullptr;
+    PassStatsCollector* pass_stats = nullptr;
+    std::vector<std::string_view> include_paths;
+    std::vector<std::pair<std::string_view, std::string_view>> macro_defs;
+    bool pipelined_parsing = false;
+    bool run_test_passes = false;
+    bool write_dep_file = false;
+    std::string dep_file_name;    // derived from the input file name if empty
+    std::string dep_file_target;  // derived from the input file name if empty
+};
+
+void appendMakeEscaped(std::string& s, std::string_view file_name) {
+    for (char ch : file_name) {
+        if (ch == ' ' || ch == '#') {
+            s += '\\';
+        } else if (ch == '$') {
+            s += '$';
+        }
+        s += ch;
+    }
+}
+
+// Writes a Makefile-style rule listing all files read by the compilation; the main file goes first
+bool writeDepFile(const std::string& file_name, const CompilationOptions& opts,
+                  const std::vector<std::string_view>& dependencies) {
+    std::filesystem::path path(opts.dep_file_name);
+    if (path.empty()) { path = std::filesystem::path(file_name).replace_extension(".d"); }
+    if (path.is_relative() && !opts.working_dir.empty()) { path = opts.working_dir / path; }
+
+    std::string text;
+    appendMakeEscaped(text, !opts.dep_file_target.empty() ?
+                                opts.dep_file_target :
+                                std::filesystem::path(file_name).replace_extension(".o").generic_string());
+    text += ':';
+    for (std::string_view dep : dependencies) {
+        text += " \\\n ";
+        appendMakeEscaped(text, dep);
+    }
+    text += '\n';
+
+    uxs::filebuf ofile(path.generic_string().c_str(), "w");
+    if (!ofile || !ofile.write(text)) {
+        logger::fatal().println("could not write dependency file `{}`", path.generic_string());
+        return false;
+    }
+    return true;
+}
+
+std::uint64_t makeBuildCacheKey(const std::string& file_name, const CompilationOptions& opts) {
+    util::fnv1a_hasher hasher;
+    hasher.update_field(XSTR(VERSION)).update_field(opts.working_dir).update_field(file_name);
+    hasher.update_field(uxs::to_string(logger::g_debug_level));  // affects captured messages
+    if (opts.run_test_passes) { hasher.update_field("--test-passes"); }
+    for (std::string_view path : opts.include_paths) { hasher.update_field("-I").update_field(path); }
+    for (const auto& [id, value] : opts.macro_defs) { hasher.update_field("-D").update_field(id).update_field(value); }
+    return hasher.value();
+}
+
+PassResult runPasses(const std::string& file_name, const CompilationOptions& opts,
+                     std::unique_ptr<CompilationContext>& ctx) {
+    ctx = std::make_unique<CompilationContext>(file_name);
+    ctx->working_dir = opts.working_dir;
+    ctx->pool = opts.pool;
+    ctx->pass_stats = opts.pass_stats;
+    ctx->include_paths = opts.include_paths;
+    ctx->pipelined_parsing = opts.pipelined_parsing;
+    ctx->run_test_passes = opts.run_test_passes;
+    std::shared_ptr<IncludePrefetcher> prefetcher;
+    if (opts.io_pool) {
+        prefetcher = std::make_shared<IncludePrefetcher>(*opts.io_pool, opts.working_dir, opts.include_paths);
+        ctx->prefetcher = prefetcher.get();
+    }
+    for (const auto& [id_text, value] : opts.macro_defs) {
+        const Identifier id(id_text);
+        auto macro_def = std::make_unique<MacroDefinition>(MacroDefinition::Type::kUserDefined, id);
+        macro_def->text = TextRange{value.data(), value.data() + value.size()};
+        ctx->macro_defs[id] = std::move(macro_def);
+    }
+    PassResult result = PassManager::getInstance().run(*ctx);
+    ctx->prefetcher = nullptr;
+    logger::info(file_name).println("warnings {}, errors {}", ctx->warning_count.load(), ctx->error_count.load());
+    return result;
+}
+
+PassResult compileFile(const std::string& file_name, const CompilationOptions& opts) {
+    std::unique_ptr<CompilationContext> ctx;
+    if (!opts.cache) {
+        PassResult result = runPasses(file_name, opts, ctx);
+        if (result != PassResult::kFatalError && opts.write_dep_file &&
+            !writeDepFile(file_name, opts, ctx->dependencies)) {
+            return PassResult::kFatalError;
+        }
+        return result;
+    }
+
+    // Replay messages of the previous compilation if nothing it depends on has changed
+    const std::uint64_t key = makeBuildCacheKey(file_name, opts);
+    PassResult result = PassResult::kSuccess;
+    std::string output;
+    std::vector<std::string> cached_dependencies;
+    if (opts.cache->lookup(key, result, output, opts.write_dep_file ? &cached_dependencies : nullptr)) {
+        logger::writeOutput(output);
+        if (opts.write_dep_file &&
+            !writeDepFile(file_name, opts, {cached_dependencies.begin(), cached_dependencies.end()})) {
+            return PassResult::kFatalError;
+        }
+        return result;
+    }
+
+    {
+        logger::OutputCapture capture(output);
+        result = runPasses(file_name, opts, ctx);
+    }
+    logger::writeOutput(output);
+    if (result != PassResult::kFatalError) {
+        opts.cache->store(key, *ctx, result, output);
+        if (opts.write_dep_file && !writeDepFile(file_name, opts, ctx->dependencies)) {
+            return PassResult::kFatalError;
+        }
+    }
+    return result;
+}
+
+bool compileFilesInParallel(util::work_stealing_pool& pool, const std::vector<std::string>& file_names,
+                            const CompilationOptions& opts) {
+    // Each translation unit is compiled by a worker having its own configured pass set. Messages are captured per
+    // translation unit and printed in input file order, so the output is the same as for sequential compilation:
+    // nothing is printed after the first failed translation unit
+    struct CompilationResult {
+        PassResult result = PassResult::kSuccess;
+        bool is_done = false;
+        std::string output;
+    };
+
+    std::vector<CompilationResult> results(file_names.size());
+    std::atomic<std::size_t> first_failed{file_names.size()};
+    std::mutex output_mtx;
+    std::size_t n_next_output = 0;
+    bool is_failed = false;
+
+    const unsigned debug_level = logger::g_debug_level;
+    auto* output_buf = logger::OutputCapture::getBuffer();
+
+    pool.parallel_for(file_names.size(), [&](std::size_t n_file) {
+        // Sequential compilation would not reach this file
+        if (n_file > first_failed.load(std::memory_order_relaxed)) { return; }
+
+        logger::DebugLevelScope debug_level_scope(debug_level);
+
+        auto& result = results[n_file];
+        {
+            logger::OutputCapture capture(result.output);
+            result.result = compileFile(file_names[n_file], opts);
+        }
+
+        if (result.result != PassResult::kSuccess) {
+            std::size_t n_failed = first_failed.load(std::memory_order_relaxed);
+            while (n_file < n_failed && !first_failed.compare_exchange_weak(n_failed, n_file)) {}
+        }
+
+        std::lock_guard lk(output_mtx);
+        result.is_done = true;
+        logger::OutputCapture capture(output_buf);
+        while (!is_failed && n_next_output < results.size() && results[n_next_output].is_done) {
+            auto& next_result = results[n_next_output++];
+            logger::writeOutput(next_result.output);
+            next_result.output = std::string();
+            is_failed = next_result.result != PassResult::kSuccess;
+        }
+    });
+
+    return !is_failed;
+}
+
+}  // namespace
+
+int daisy::runCompiler(int argc, char** argv, const DriverEnvironment& env, std::string& out) {
+    try {
+        bool show_help = false, show_version = false;
+        bool time_passes = false, time_passes_json = false;
+        std::string server_socket, connect_socket, cache_dir;
+        unsigned job_count = 1, io_thread_count = 0;
+        std::vector<std::string> input_file_names;
+        CompilationOptions opts;
+        opts.working_dir = env.working_dir;
+
+        std::string_view keyword_macro_id;
+        auto add_definition = [&macro_defs = opts.macro_defs, &keyword_macro_id](std::string_view def) {
+            if (!uxs::is_alpha(def[0]) && def[0] != '_') { return false; }
+            std::string_view val;
+            auto pos = def.find('=');
+            if (pos != std::string::npos) {
+                val = def.substr(pos + 1);
+                def = def.substr(0, pos);
+            } else {
+                val = "1";
+            }
+            if (!uxs::all_of(def.substr(1), [](char ch) { return uxs::is_alnum(ch) || ch == '_'; })) { return false; }
+            // Note: keywords are recognized before macro expansion, so such a definition would be silently ignored
+            if (DaisyParserPass::isKeyword(def)) {
+                keyword_macro_id = def;
+                return true;
+            }
+            macro_defs.emplace_back(std::make_pair(def, val));
+            return true;
+        };
+
+        auto cli = uxs::cli::command(argv[0])
+                   << uxs::cli::overview("the Daisy compiler") << uxs::cli::values("filename...", input_file_names)
+                   << (uxs::cli::option({"-I"}) &
+                       uxs::cli::basic_value_wrapper<char>("<dir>",
+                                                           [&opts](std::string_view path) {
+                                                               opts.include_paths.emplace_back(path);
+                                                               return true;
+                                                           })) %
+                          "Add directory <dir> to the end of the list of include search paths."
+                   << (uxs::cli::option({"-D"}) &
+                       uxs::cli::basic_value_wrapper<char>("<macro>={<value>}", add_definition)) %
+                          "Define <macro> to <value> (or 1 if <value> omitted)."
+                   << uxs::cli::option({"-MD"}).set(opts.write_dep_file) %
+                          "Write a Makefile-style list of files the input depends on to a dependency file."
+                   << (uxs::cli::option({"-MF"}) & uxs::cli::value("<file>", opts.dep_file_name)) %
+                          "Write dependencies to <file> (by default, the input file name with `.d` extension)."
+                   << (uxs::cli::option({"-MT"}) & uxs::cli::value("<target>", opts.dep_file_target)) %
+                          "Use <target> as the rule target (by default, the input file name with `.o` extension)."
+                   << (uxs::cli::option({"-d", "--debug-level="}) & uxs::cli::value("<n>", logger::g_debug_level)) %
+                          "Debug verbosity level."
+                   << (uxs::cli::option({"-j", "--jobs="}) & uxs::cli::value("<n>", job_count)) %
+                          "Compile up to <n> input files or functions in parallel (0 - use all hardware threads)."
+                   << (uxs::cli::option({"--io-threads="}) & uxs::cli::value("<n>", io_thread_count)) %
+                          "Prefetch included files on <n> background I/O threads (0 - disabled)."
+                   << uxs::cli::option({"--pipeline-parsing"}).set(opts.pipelined_parsing) %
+                          "Preprocess each input file on a separate thread while parsing it."
+                   << uxs::cli::option({"--test-passes"}).set(opts.run_test_passes) %
+                          "Run passes checking the pass manager (for compiler testing)."
+                   << uxs::cli::option({"--time-passes"}).set(time_passes) %
+                          "Report wall time, CPU time and memory usage of each pass."
+                   << uxs::cli::option({"--time-passes-json"}).set(time_passes_json) %
+                          "Report pass execution statistics in JSON format."
+                   << (uxs::cli::option({"--cache-dir="}) & uxs::cli::value("<dir>", cache_dir)) %
+                          "Reuse results of previous compilations stored in directory <dir>."
+                   << (uxs::cli::option({"--server="}) & uxs::cli::value("<socket>", server_socket)) %
+                          "Run as a compile server listening on local socket <socket>."
+                   << (uxs::cli::option({"--connect="}) & uxs::cli::value("<socket>", connect_socket)) %
+                          "Forward the command line to the compile server listening on local socket <socket>."
+                   << uxs::cli::option({"-h", "--help"}).set(show_help) % "Display this information."
+                   << uxs::cli::option({"-V", "--version"}).set(show_version) % "Display version.";
+
+        auto parse_result = cli->parse(argc, argv);
+        if (show_help) {
+            out += parse_result.node->get_command()->make_man_page(uxs::cli::text_coloring::colored);
+            return 0;
+        } else if (show_version) {
+            uxs::basic_format(out, "{}\n", XSTR(VERSION));
+            return 0;
+        } else if (parse_result.status != uxs::cli::parsing_status::ok &&
+                   (parse_result.status != uxs::cli::parsing_status::unspecified_value || server_socket.empty())) {
+            switch (parse_result.status) {
+                case uxs::cli::parsing_status::unknown_option: {
+                    logger::fatal().println("unknown command line option `{}`", argv[parse_result.argc_parsed]);
+                } break;
+                case uxs::cli::parsing_status::invalid_value: {
+                    if (parse_result.argc_parsed < argc) {
+                        logger::fatal().println("invalid command line argument `{}`", argv[parse_result.argc_parsed]);
+                    } else {
+                        logger::fatal().println("expected command line argument after `{}`",
+                                                argv[parse_result.argc_parsed - 1]);
+                    }
+                } break;
+                case uxs::cli::parsing_status::unspecified_value: {
+                    if (input_file_names.empty()) { logger::fatal().println("no input files specified"); }
+                } break;
+                default: break;
+            }
+            return -1;
+        } else if (!keyword_macro_id.empty()) {
+            logger::fatal().println("keyword `{}` cannot be used as macro identifier", keyword_macro_id);
+            return -1;
+        }
+
+        if (job_count == 0) { job_count = std::max(std::thread::hardware_concurrency(), 1u); }
+
+        if ((!server_socket.empty() || !connect_socket.empty()) && env.is_server_request) {
+            logger::fatal().println("compile server cannot be started or connected by a compile server request");
+            return -1;
+        } else if (!server_socket.empty()) {
+            return runCompileServer(server_socket, job_count);
+        } else if (!connect_socket.empty()) {
+            std::vector<char*> forwarded_argv;
+            forwarded_argv.reserve(argc);
+            for (int i = 0; i < argc; ++i) {
+                if (std::string_view(argv[i]).substr(0, 10) != "--connect=") { forwarded_argv.push_back(argv[i]); }
+            }
+            int ret_code = 0;
+            if (forwardToCompileServer(connect_socket, static_cast<int>(forwarded_argv.size()), forwarded_argv.data(),
+                                       env.working_dir, ret_code, out)) {
+                return ret_code;
+            }
+            // Compile locally if the server is not reachable
+        }
+
+        if (input_file_names.size() > 1 && (!opts.dep_file_name.empty() || !opts.dep_file_target.empty())) {
+            logger::fatal().println("cannot specify `-MF` or `-MT` with multiple input files");
+            return -1;
+        }
+
+        // Note: statistics are collected per compiler run, so compile server requests do not mix them
+        std::unique_ptr<PassStatsCollector> pass_stats;
+        if (time_passes || time_passes_json) {
+            opts.pass_stats = (pass_stats = std::make_unique<PassStatsCollector>()).get();
+        }
+
+        std::unique_ptr<BuildCache> cache;
+        if (!cache_dir.empty()) {
+            std::filesystem::path path(cache_dir);
+            if (path.is_relative() && !env.working_dir.empty()) { path = env.working_dir / path; }
+            opts.cache = (cache = std::make_unique<BuildCache>(path.generic_string())).get();
+        }
+
+        // Note: the pool is used for both file-level and function-level parallelism
+        std::unique_ptr<util::work_stealing_pool> local_pool;
+        if (job_count > 1) {
+            opts.pool = env.pool;
+            if (!opts.pool) { opts.pool = (local_pool = std::make_unique<util::work_stealing_pool>(job_count)).get(); }
+        }
+
+        std::unique_ptr<util::work_stealing_pool> io_pool;
+        if (io_thread_count > 0) {
+            opts.io_pool = (io_pool = std::make_unique<util::work_stealing_pool>(io_thread_count)).get();
+        }
+
+        int ret_code = 0;
+        if (opts.pool && input_file_names.size() > 1) {
+            if (!compileFilesInParallel(*opts.pool, input_file_names, opts)) { ret_code = -1; }
+        } else {
+            for (const auto& file_name : input_file_names) {
+                if (compileFile(file_name, opts) != PassResult::kSuccess) {
+                    ret_code = -1;
+                    break;
+                }
+            }
+        }
+
+        if (time_passes_json) {
+            out += pass_stats->makeJsonReport();
+        } else if (time_passes) {
+            out += pass_stats->makeTableReport();
+        }
+
+        return ret_code;
+    } catch (const std::exception& e) { logger::fatal().println("exception caught: {}", e.what()); }
+    return -1;
+}
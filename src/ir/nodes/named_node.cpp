@@ -9,7 +9,7 @@ RTTI_IMPLEMENT_TYPE_INFO(ir::NamedNode);
 
 std::string ir::NamedNode::getGlobalName() const {
     const auto* parent = getParent();
-    if (!util::is_kind_of<NamedScopeNode>(parent)) { return name_; }
+    if (!util::is_kind_of<NamedScopeNode>(parent)) { return std::string(name_.getText()); }
 
     std::vector<const NamedScopeNode*> path;
     path.reserve(16);
@@ -17,13 +17,13 @@ std::string ir::NamedNode::getGlobalName() const {
     while (util::is_kind_of<NamedScopeNode>((parent = parent->getNamespace().getParentScope()))) {
         path.push_back(static_cast<const NamedScopeNode*>(parent));
     }
-    if (!util::is_kind_of<RootNode>(parent)) { return name_; }
+    if (!util::is_kind_of<RootNode>(parent)) { return std::string(name_.getText()); }
 
     std::string global_name;
     for (const auto& scope : uxs::make_reverse_range(path)) {
-        global_name += scope->getName();
+        global_name += scope->getName().getText();
         global_name += "::";
     }
-    global_name += name_;
+    global_name += name_.getText();
     return global_name;
 }
@@ -2,13 +2,26 @@
 
 #include "ctx/ctx.h"
 
-unsigned daisy::logger::g_debug_level = 1;
+thread_local unsigned daisy::logger::g_debug_level = 1;
 
 using namespace daisy;
 using namespace daisy::logger;
 
 namespace {
 
+thread_local std::string* g_output_buf = nullptr;
+thread_local MessageCounts g_thread_message_counts;
+
+template<typename... Args>
+void printLn(uxs::format_string<Args...> fmt, const Args&... args) {
+    if (g_output_buf) {
+        uxs::basic_format(*g_output_buf, fmt, args...);
+        g_output_buf->push_back('\n');
+        return;
+    }
+    uxs::println(uxs::stdbuf::log(), fmt, args...);
+}
+
 std::pair<std::string, std::string> markInputLine(std::string_view line, unsigned first, unsigned last) {
     // Note: `first` - left marking boundary, starts from 1; value 0 - no boundary
     // Note: `last` - right marking inclusive boundary, starts from 1; value 0 - no boundary
@@ -80,26 +93,38 @@ void printMessageImpl(MsgType type, const SymbolLoc& loc, std::string_view msg)
     assert(file);
 
     std::string n_line = uxs::to_string(loc.first.ln);
-    uxs::println(uxs::stdbuf::log(), "\033[1;37m{}:{}:{}{}{}", file->file_name, n_line, loc.first.col, typeString(type),
-                 msg);
+    printLn("\033[1;37m{}:{}:{}{}{}", file->file_name, n_line, loc.first.col, typeString(type), msg);
 
     std::string left_padding(n_line.size(), ' ');
-    const auto& text_lines = file->text_lines;
 
     for (unsigned ln = loc.first.ln; ln <= loc.last.ln; ++ln) {
         // Note: line and column numbers start from 1
-        auto [tab2space_line, mark] = markInputLine(text_lines[ln - 1], ln == loc.first.ln ? loc.first.col : 0,
+        auto [tab2space_line, mark] = markInputLine(file->source->getLine(ln), ln == loc.first.ln ? loc.first.col : 0,
                                                     ln == loc.last.ln ? loc.last.col : 0);
-        uxs::println(uxs::stdbuf::log(), " {} | {}", ln == loc.first.ln ? n_line : left_padding, tab2space_line);
-        uxs::println(uxs::stdbuf::log(), " {} | \033[0;32m{}\033[0m", left_padding, mark);
+        printLn(" {} | {}", ln == loc.first.ln ? n_line : left_padding, tab2space_line);
+        printLn(" {} | \033[0;32m{}\033[0m", left_padding, mark);
     }
 }
 
 }  // namespace
 
+OutputCapture::OutputCapture(std::string* buf) : prev_buf_(g_output_buf) { g_output_buf = buf; }
+OutputCapture::~OutputCapture() { g_output_buf = prev_buf_; }
+/*static*/ std::string* OutputCapture::getBuffer() { return g_output_buf; }
+
+void daisy::logger::writeOutput(std::string_view text) {
+    if (g_output_buf) {
+        g_output_buf->append(text);
+        return;
+    }
+    uxs::stdbuf::log().write(text);
+}
+
+MessageCounts daisy::logger::getThreadMessageCounts() { return g_thread_message_counts; }
+
 LoggerSimple& LoggerSimple::show() {
     if (getType() >= MsgType::kInfo + g_debug_level) { return *this; }
-    uxs::println(uxs::stdbuf::log(), "\033[1;37m{}{}{}", header_, typeString(getType()), getMessage());
+    printLn("\033[1;37m{}{}{}", header_, typeString(getType()), getMessage());
     clear();
     return *this;
 }
@@ -116,9 +141,13 @@ LoggerExtended& LoggerExtended::show() {
     const auto* loc_ctx = loc_stack.back()->loc_ctx;
     assert(loc_ctx->file && loc_ctx->file->compilation_ctx);
     switch (getType()) {
-        case MsgType::kWarning: ++loc_ctx->file->compilation_ctx->warning_count; break;
-        case MsgType::kError: ++loc_ctx->file->compilation_ctx->error_count; break;
-        case MsgType::kFatal: ++loc_ctx->file->compilation_ctx->error_count; break;
+        case MsgType::kWarning: {
+            ++loc_ctx->file->compilation_ctx->warning_count, ++g_thread_message_counts.warnings;
+        } break;
+        case MsgType::kError:
+        case MsgType::kFatal: {
+            ++loc_ctx->file->compilation_ctx->error_count, ++g_thread_message_counts.errors;
+        } break;
         default: break;
     }
 
@@ -127,8 +156,7 @@ LoggerExtended& LoggerExtended::show() {
     while (it != loc_stack.rend() - 1 && !(*(it + 1))->loc_ctx->expansion.macro_def) {
         assert((*it)->loc_ctx->file);
         if (print_ext_loc_info_) {
-            uxs::println(uxs::stdbuf::log(), "In file included from {}:{}", (*it)->loc_ctx->file->file_name,
-                         (*it)->first.ln);
+            printLn("In file included from {}:{}", (*it)->loc_ctx->file->file_name, (*it)->first.ln);
         }
         ++it;
     }
@@ -142,7 +170,8 @@ LoggerExtended& LoggerExtended::show() {
             const auto* loc_ctx = (*it)->loc_ctx;
             if (!loc_ctx->file) { break; }
             if (const auto* macro_def = loc_ctx->expansion.macro_def; macro_def) {
-                printMessageImpl(MsgType::kNote, **it, uxs::format("expanded from macro `{}`", macro_def->id));
+                printMessageImpl(MsgType::kNote, **it,
+                                 uxs::format("expanded from macro `{}`", macro_def->id.getText()));
             }
         }
     }
@@ -1,33 +1,111 @@
 #include "pass_manager.h"
 
+#include "ctx/ctx.h"
+#include "ir/nodes/func_def_node.h"
+#include "logger.h"
+#include "pass_stats.h"
+#include "util/work_stealing_pool.h"
+
 #include <uxs/algorithm.h>
+#include <uxs/format.h>
+
+#include <stdexcept>
 
 using namespace daisy;
 
-/*static*/ Pass* Pass::first_avail_ = nullptr;
+/*static*/ const PassFactory* PassFactory::first_avail = nullptr;
+
+namespace {
+
+// Note: nested functions go after their enclosing function
+void collectDefinedFunctions(ir::Node& node, std::vector<ir::FuncDefNode*>& funcs) {
+    for (auto& child : node) {
+        if (auto* func = util::cast<ir::FuncDefNode*>(&child); func && func->isDefined()) { funcs.push_back(func); }
+        collectDefinedFunctions(child, funcs);
+    }
+}
+
+PassResult combinePassResults(PassResult lhs, PassResult rhs) { return std::max(lhs, rhs); }
+
+}  // namespace
 
 /*static*/ PassManager& PassManager::getInstance() {
-    static PassManager pass_manager;
+    // Note: each thread has its own set of passes, configured on the first use
+    thread_local PassManager pass_manager;
+    if (!pass_manager.is_configured_) { pass_manager.configure(); }
     return pass_manager;
 }
 
 Pass* PassManager::findPassByName(std::string_view name) const {
-    auto [it, found] = uxs::find_if(passes_, [name](auto* pass) { return pass->getName() == name; });
-    if (found) { return *it; }
+    auto [it, found] = uxs::find_if(passes_, [name](const auto& entry) { return entry.pass->getName() == name; });
+    if (found) { return it->pass.get(); }
     return nullptr;
 }
 
 void PassManager::configure() {
-    passes_.reserve(32);
-    for (auto* pass = Pass::first_avail_; pass; pass = pass->next_avail_) { passes_.push_back(pass); }
-    for (auto* pass : passes_) { pass->configure(); }
+    is_configured_ = true;
+
+    std::vector<std::unique_ptr<Pass>> passes;
+    passes.reserve(32);
+    for (const auto* factory = PassFactory::first_avail; factory; factory = factory->next_avail) {
+        passes.emplace_back(factory->func());
+    }
+
+    std::vector<AnalysisUsage> usages(passes.size());
+    for (std::size_t n = 0; n < passes.size(); ++n) { passes[n]->getAnalysisUsage(usages[n]); }
+
+    auto find_pass = [&passes](std::string_view name) {
+        auto [it, found] = uxs::find_if(passes, [name](const auto& pass) { return pass->getName() == name; });
+        if (!found) { throw std::runtime_error(uxs::format("required pass `{}` is not registered", name)); }
+        return static_cast<std::size_t>(it - passes.begin());
+    };
+
+    // Topologically sort passes so that required passes go first, preserving registration order where possible
+    enum class VisitState { kNotVisited = 0, kVisiting, kVisited };
+    std::vector<VisitState> states(passes.size(), VisitState::kNotVisited);
+    std::vector<std::size_t> order;
+    order.reserve(passes.size());
+
+    auto visit = [&](const auto& visit, std::size_t n) -> void {
+        if (states[n] == VisitState::kVisited) { return; }
+        if (states[n] == VisitState::kVisiting) {
+            throw std::runtime_error(uxs::format("cyclic dependency of pass `{}`", passes[n]->getName()));
+        }
+        states[n] = VisitState::kVisiting;
+        for (std::string_view name : usages[n].getRequired()) { visit(visit, find_pass(name)); }
+        states[n] = VisitState::kVisited;
+        order.push_back(n);
+    };
+
+    for (std::size_t n = 0; n < passes.size(); ++n) { visit(visit, n); }
+
+    passes_.clear();
+    passes_.reserve(passes.size());
+    std::vector<std::size_t> entry_index(passes.size());
+    for (std::size_t n : order) {
+        entry_index[n] = passes_.size();
+        passes_.emplace_back(PassEntry{std::move(passes[n]), std::move(usages[n]), {}});
+    }
+
+    // Note: `passes_` is not resized anymore, so pointers to entries are stable
+    for (auto& entry : passes_) {
+        for (std::string_view name : entry.usage.getRequired()) {
+            auto [it, found] = uxs::find_if(passes_,
+                                            [name](const auto& other) { return other.pass->getName() == name; });
+            entry.required.push_back(&*it);
+        }
+    }
+
+    for (const auto& entry : passes_) { entry.pass->configure(); }
 }
 
 PassResult PassManager::run(CompilationContext& ctx) {
     PassResult result = PassResult::kSuccess;
-    for (auto* pass : passes_) {
-        PassResult pass_result = pass->run(ctx);
-        pass->cleanup();
+    for (const auto& entry : passes_) {
+        // Analysis can be already computed for a previous consumer
+        if (entry.pass->isAnalysis() && ctx.isAnalysisValid(entry.pass->getName())) { continue; }
+        PassResult pass_result = ensureRequired(entry, ctx);
+        if (pass_result == PassResult::kSuccess) { pass_result = runPass(entry, ctx); }
         switch (pass_result) {
             case PassResult::kError: result = PassResult::kError; break;
             case PassResult::kFatalError: return PassResult::kFatalError;
@@ -36,3 +114,77 @@ PassResult PassManager::run(CompilationContext& ctx) {
     }
     return result;
 }
+
+PassResult PassManager::ensureRequired(const PassEntry& entry, CompilationContext& ctx) {
+    // Required analyses could be invalidated by transforms executed since they were computed
+    for (const auto* required : entry.required) {
+        // Note: required transforms are already executed because of dependency order
+        if (!required->pass->isAnalysis()) { continue; }
+        PassResult result = PassResult::kSuccess;
+        if (ctx.isAnalysisValid(required->pass->getName())) {
+            result = ctx.getAnalysisPassResult(required->pass->getName());
+        } else {
+            result = ensureRequired(*required, ctx);
+            if (result == PassResult::kSuccess) { result = runPass(*required, ctx); }
+        }
+        if (result != PassResult::kSuccess) { return result; }
+    }
+    return PassResult::kSuccess;
+}
+
+PassResult PassManager::runPass(const PassEntry& entry, CompilationContext& ctx) {
+    Pass& pass = *entry.pass;
+    PassResult result = PassResult::kSuccess;
+    if (!ctx.pass_stats) {
+        result = pass.run(ctx);
+        pass.cleanup();
+    } else {
+        {
+            PassStatsScope stats_scope(*ctx.pass_stats, pass.getName(), PassPhase::kRun);
+            result = pass.run(ctx);
+        }
+        PassStatsScope stats_scope(*ctx.pass_stats, pass.getName(), PassPhase::kCleanup);
+        pass.cleanup();
+    }
+    if (pass.isAnalysis()) {
+        ctx.setAnalysisPassResult(pass.getName(), result);
+    } else {
+        ctx.invalidateAnalyses([&usage = entry.usage](std::string_view name) { return !usage.isPreserved(name); });
+    }
+    return result;
+}
+
+PassResult FunctionPass::run(CompilationContext& ctx) {
+    std::vector<ir::FuncDefNode*> funcs;
+    if (ctx.ir_root) { collectDefinedFunctions(*ctx.ir_root, funcs); }
+
+    PassResult result = PassResult::kSuccess;
+    if (!ctx.pool || funcs.size() < 2) {
+        for (auto* func : funcs) { result = combinePassResults(result, runOnFunction(ctx, *func)); }
+        return result;
+    }
+
+    struct FunctionResult {
+        PassResult result = PassResult::kSuccess;
+        std::string output;
+    };
+
+    std::vector<FunctionResult> results(funcs.size());
+    const unsigned debug_level = logger::g_debug_level;
+    const std::string_view pass_name = getName();
+    PassStatsScope* stats_scope = ctx.pass_stats ? PassStatsScope::getCurrent() : nullptr;
+
+    ctx.pool->parallel_for(funcs.size(), [&](std::size_t n_func) {
+        PassStatsHelperScope stats_helper_scope(stats_scope);
+        logger::DebugLevelScope debug_level_scope(debug_level);
+        auto* pass = static_cast<FunctionPass*>(PassManager::getInstance().findPassByName(pass_name));
+        logger::OutputCapture capture(results[n_func].output);
+        results[n_func].result = pass->runOnFunction(ctx, *funcs[n_func]);
+    });
+
+    for (const auto& func_result : results) {
+        logger::writeOutput(func_result.output);
+        result = combinePassResults(result, func_result.result);
+    }
+    return result;
+}
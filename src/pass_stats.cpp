@@ -0,0 +1,267 @@
+#include "pass_stats.h"
+
+#include <uxs/format.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <new>
+
+#if defined(_WIN32)
+#    define WIN32_LEAN_AND_MEAN
+#    include <windows.h>
+#    include <psapi.h>
+#else
+#    include <sys/resource.h>
+#    include <time.h>
+#    include <unistd.h>
+#    include <cstdio>
+#endif
+
+using namespace daisy;
+
+namespace {
+
+// Allocation counters are bumped by replaced global `operator new` only since the first collector is created
+std::atomic<bool> g_count_allocs{false};
+thread_local std::uint64_t g_alloc_count = 0;
+thread_local std::uint64_t g_alloc_bytes = 0;
+
+thread_local PassStatsScope* g_current_scope = nullptr;
+
+#if defined(DAISY_COUNT_ALLOCATIONS)
+void countAlloc(std::size_t sz) noexcept {
+    if (g_count_allocs.load(std::memory_order_relaxed)) { ++g_alloc_count, g_alloc_bytes += sz; }
+}
+
+void* allocate(std::size_t sz) noexcept {
+    countAlloc(sz);
+    return std::malloc(sz ? sz : 1);
+}
+
+void* allocateAligned(std::size_t sz, std::align_val_t al) noexcept {
+    countAlloc(sz);
+#    if defined(_WIN32)
+    return ::_aligned_malloc(sz ? sz : 1, static_cast<std::size_t>(al));
+#    else
+    void* p = nullptr;
+    const std::size_t alignment = std::max(static_cast<std::size_t>(al), sizeof(void*));
+    return ::posix_memalign(&p, alignment, sz ? sz : 1) == 0 ? p : nullptr;
+#    endif
+}
+
+void deallocateAligned(void* p) noexcept {
+#    if defined(_WIN32)
+    ::_aligned_free(p);
+#    else
+    std::free(p);
+#    endif
+}
+#endif  // defined(DAISY_COUNT_ALLOCATIONS)
+
+double getThreadCpuTime() {
+#if defined(_WIN32)
+    FILETIME creation_time, exit_time, kernel_time, user_time;
+    if (!::GetThreadTimes(::GetCurrentThread(), &creation_time, &exit_time, &kernel_time, &user_time)) { return 0; }
+    auto to_uint64 = [](const FILETIME& t) {
+        return (static_cast<std::uint64_t>(t.dwHighDateTime) << 32) | t.dwLowDateTime;
+    };
+    return 1e-7 * static_cast<double>(to_uint64(kernel_time) + to_uint64(user_time));  // 100ns units
+#else
+    timespec ts{};
+    if (::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) { return 0; }
+    return static_cast<double>(ts.tv_sec) + 1e-9 * static_cast<double>(ts.tv_nsec);
+#endif
+}
+
+std::int64_t getCurrentRss() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters))) { return 0; }
+    return static_cast<std::int64_t>(counters.WorkingSetSize);
+#elif defined(__linux__)
+    std::FILE* f = std::fopen("/proc/self/statm", "r");
+    if (!f) { return 0; }
+    long total_pages = 0, resident_pages = 0;
+    int n_read = std::fscanf(f, "%ld %ld", &total_pages, &resident_pages);
+    std::fclose(f);
+    return n_read == 2 ? static_cast<std::int64_t>(resident_pages) * ::sysconf(_SC_PAGESIZE) : 0;
+#else
+    return 0;
+#endif
+}
+
+std::int64_t getPeakRss() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!::GetProcessMemoryInfo(::GetCurrentProcess(), &counters, sizeof(counters))) { return 0; }
+    return static_cast<std::int64_t>(counters.PeakWorkingSetSize);
+#else
+    rusage usage{};
+    if (::getrusage(RUSAGE_SELF, &usage) != 0) { return 0; }
+#    if defined(__APPLE__)
+    return static_cast<std::int64_t>(usage.ru_maxrss);  // bytes
+#    else
+    return static_cast<std::int64_t>(usage.ru_maxrss) * 1024;  // kilobytes
+#    endif
+#endif
+}
+
+std::string_view phaseSuffix(PassPhase phase) { return phase == PassPhase::kCleanup ? " (cleanup)" : ""; }
+
+}  // namespace
+
+#if defined(DAISY_COUNT_ALLOCATIONS)
+// Note: every allocation of the process pays for a relaxed atomic load and a branch here, even with no collector; the
+// `COUNT_ALLOCATIONS` build option turns the replacement off, then allocation counters stay zero
+void* operator new(std::size_t sz) {
+    if (void* p = allocate(sz)) { return p; }
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t sz) {
+    if (void* p = allocate(sz)) { return p; }
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t sz, const std::nothrow_t&) noexcept { return allocate(sz); }
+void* operator new[](std::size_t sz, const std::nothrow_t&) noexcept { return allocate(sz); }
+void* operator new(std::size_t sz, std::align_val_t al) {
+    if (void* p = allocateAligned(sz, al)) { return p; }
+    throw std::bad_alloc();
+}
+void* operator new[](std::size_t sz, std::align_val_t al) {
+    if (void* p = allocateAligned(sz, al)) { return p; }
+    throw std::bad_alloc();
+}
+void* operator new(std::size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return allocateAligned(sz, al);
+}
+void* operator new[](std::size_t sz, std::align_val_t al, const std::nothrow_t&) noexcept {
+    return allocateAligned(sz, al);
+}
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { deallocateAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { deallocateAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept { deallocateAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept { deallocateAligned(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { deallocateAligned(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { deallocateAligned(p); }
+#endif  // defined(DAISY_COUNT_ALLOCATIONS)
+
+PassStats& PassStats::operator+=(const PassStats& other) {
+    count += other.count;
+    wall_time += other.wall_time;
+    cpu_time += other.cpu_time;
+    alloc_count += other.alloc_count;
+    alloc_bytes += other.alloc_bytes;
+    rss_delta += other.rss_delta;
+    return *this;
+}
+
+PassStatsCollector::PassStatsCollector() { g_count_allocs.store(true, std::memory_order_relaxed); }
+
+std::uint64_t daisy::getThreadAllocCount() { return g_alloc_count; }
+
+void PassStatsCollector::add(std::string_view pass_name, PassPhase phase, const PassStats& stats) {
+    std::lock_guard lk(mtx_);
+    for (auto& entry : entries_) {
+        if (entry.pass_name == pass_name && entry.phase == phase) {
+            entry.stats += stats;
+            return;
+        }
+    }
+    entries_.emplace_back(Entry{std::string(pass_name), phase, stats});
+}
+
+std::string PassStatsCollector::makeTableReport() const {
+    std::lock_guard lk(mtx_);
+    std::string report;
+    PassStats total;
+    uxs::basic_format(report, "===== Pass execution statistics =====\n");
+    uxs::basic_format(report, "{:>12} {:>12} {:>12} {:>14} {:>14} {:>6}  {}\n", "Wall (s)", "CPU (s)", "Allocs",
+                      "Alloc bytes", "RSS delta", "Runs", "Pass");
+    for (const auto& entry : entries_) {
+        const auto& stats = entry.stats;
+        uxs::basic_format(report, "{:>12.6f} {:>12.6f} {:>12} {:>14} {:>14} {:>6}  {}{}\n", stats.wall_time,
+                          stats.cpu_time, stats.alloc_count, stats.alloc_bytes, stats.rss_delta, stats.count,
+                          entry.pass_name, phaseSuffix(entry.phase));
+        total += stats;
+    }
+    uxs::basic_format(report, "{:>12.6f} {:>12.6f} {:>12} {:>14} {:>14} {:>6}  Total\n", total.wall_time,
+                      total.cpu_time, total.alloc_count, total.alloc_bytes, total.rss_delta, total.count);
+    uxs::basic_format(report, "Peak RSS: {} bytes\n", getPeakRss());
+    return report;
+}
+
+std::string PassStatsCollector::makeJsonReport() const {
+    std::lock_guard lk(mtx_);
+    std::string report("{\"passes\": [");
+    for (const auto& entry : entries_) {
+        const auto& stats = entry.stats;
+        uxs::basic_format(report,
+                          "{}\n  {{\"name\": {:?}, \"phase\": \"{}\", \"count\": {}, \"wall_time\": {:.6f}, "
+                          "\"cpu_time\": {:.6f}, \"alloc_count\": {}, \"alloc_bytes\": {}, \"rss_delta\": {}}}",
+                          &entry == &entries_.front() ? "" : ",", entry.pass_name,
+                          entry.phase == PassPhase::kCleanup ? "cleanup" : "run", stats.count, stats.wall_time,
+                          stats.cpu_time, stats.alloc_count, stats.alloc_bytes, stats.rss_delta);
+    }
+    uxs::basic_format(report, "\n], \"peak_rss\": {}}}\n", getPeakRss());
+    return report;
+}
+
+PassStatsScope::PassStatsScope(PassStatsCollector& collector, std::string_view pass_name, PassPhase phase)
+    : collector_(collector), pass_name_(pass_name), phase_(phase), start_(takeSnapshot()), prev_(g_current_scope) {
+    g_current_scope = this;
+}
+
+PassStatsScope::~PassStatsScope() {
+    g_current_scope = prev_;
+    const Snapshot finish = takeSnapshot();
+    PassStats stats;
+    stats.count = 1;
+    stats.wall_time = finish.wall_time - start_.wall_time;
+    stats.cpu_time = finish.cpu_time - start_.cpu_time + helper_stats_.cpu_time;
+    stats.alloc_count = finish.alloc_count - start_.alloc_count + helper_stats_.alloc_count;
+    stats.alloc_bytes = finish.alloc_bytes - start_.alloc_bytes + helper_stats_.alloc_bytes;
+    stats.rss_delta = finish.rss - start_.rss;
+    collector_.add(pass_name_, phase_, stats);
+}
+
+/*static*/ PassStatsScope* PassStatsScope::getCurrent() { return g_current_scope; }
+
+/*static*/ PassStatsScope::Snapshot PassStatsScope::takeSnapshot() {
+    const auto wall_time = std::chrono::steady_clock::now().time_since_epoch();
+    return Snapshot{std::chrono::duration<double>(wall_time).count(), getThreadCpuTime(), g_alloc_count,
+                    g_alloc_bytes, getCurrentRss()};
+}
+
+PassStatsHelperScope::PassStatsHelperScope(PassStatsScope* parent)
+    : parent_(parent != g_current_scope ? parent : nullptr), own_(g_current_scope) {
+    if (parent_) { start_ = PassStatsScope::takeSnapshot(); }
+}
+
+PassStatsHelperScope::~PassStatsHelperScope() {
+    if (!parent_) { return; }
+    const auto finish = PassStatsScope::takeSnapshot();
+    PassStats stats;
+    stats.cpu_time = finish.cpu_time - start_.cpu_time;
+    stats.alloc_count = finish.alloc_count - start_.alloc_count;
+    stats.alloc_bytes = finish.alloc_bytes - start_.alloc_bytes;
+    {
+        std::lock_guard lk(parent_->helper_mtx_);
+        parent_->helper_stats_.cpu_time += stats.cpu_time;
+        parent_->helper_stats_.alloc_count += stats.alloc_count;
+        parent_->helper_stats_.alloc_bytes += stats.alloc_bytes;
+    }
+    if (own_) {  // Note: unsigned counters wrap around, but the total of the scope is not less than this work
+        std::lock_guard lk(own_->helper_mtx_);
+        own_->helper_stats_.cpu_time -= stats.cpu_time;
+        own_->helper_stats_.alloc_count -= stats.alloc_count;
+        own_->helper_stats_.alloc_bytes -= stats.alloc_bytes;
+    }
+}
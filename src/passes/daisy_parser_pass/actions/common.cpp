@@ -7,35 +7,35 @@ using namespace daisy;
 namespace {
 
 void resolveScope(DaisyParserPass* /*pass*/, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-    const auto name = std::get<std::string_view>(ss[1].val);
-    auto& scope_desc = std::get<ir::ScopeDescriptor>(ss[0].val);
+    const auto name = ss[1].val.get<Identifier>();
+    auto& scope_desc = ss[0].val.get<ir::ScopeDescriptor>();
     if (scope_desc.getClass() != ir::ScopeClass::kInvalid) {
         if (auto* scope = scope_desc.lookupName<ir::NamedScopeNode>(name)) {
             ss[0].val.emplace<ir::ScopeDescriptor>(ir::ScopeClass::kSpecified, *scope);
             return;
         } else {
-            logger::error(ss[1].loc).println("undefined namespace identifier `{}`", name);
+            logger::error(ss[1].loc).println("undefined namespace identifier `{}`", name.getText());
         }
     }
     ss[0].val.emplace<ir::ScopeDescriptor>(ir::ScopeClass::kInvalid);
 }
 
 void beginNamespace(DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-    const auto name = std::get<std::string_view>(ss[-2].val);
+    const auto name = ss[-2].val.get<Identifier>();
     auto& nmspace = pass->getCurrentScope().getNamespace();
     auto* nmspace_node = nmspace.findNode<ir::NamedScopeNode>(name);
     if (!util::is_kind_of<ir::NamespaceNode>(nmspace_node)) {
         auto& new_nmspace_node = pass->getCurrentScope().push_back(
-            std::make_unique<ir::NamespaceNode>(std::string(name), pass->getCurrentScope(), ss[-2].loc));
+            std::make_unique<ir::NamespaceNode>(name, pass->getCurrentScope(), ss[-2].loc));
         if (!nmspace_node) {
             nmspace.addNode(new_nmspace_node);
         } else {
-            logger::error(ss[-2].loc).println("redefinition of `{}` as different kind of entity", name);
+            logger::error(ss[-2].loc).println("redefinition of `{}` as different kind of entity", name.getText());
             logger::note(nmspace_node->getLoc()).println("previous definition is here");
         }
         nmspace_node = &new_nmspace_node;
     } else {
-        logger::debug(ss[-1].loc).println("entering existing namespace `{}`", name);
+        logger::debug(ss[-1].loc).println("entering existing namespace `{}`", name.getText());
     }
     pass->setCurrentScope(*nmspace_node);
 }
@@ -45,9 +45,10 @@ void beginNamespace(DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_resolve_scope, resolveScope);
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_begin_namespace, beginNamespace);
 
+// Note: adjacent string literals are gathered and joined at once when the whole chain is parsed
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_concatenate_string_const,
-                                [](DaisyParserPass* /*pass*/, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-                                    std::get<std::string>(ss[0].val) += std::get<std::string>(ss[1].val);
+                                [](DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
+                                    pass->appendStringPiece(ss[0].val, ss[1].val.get<std::string_view>());
                                 });
 
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_local_scope, [](DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
@@ -62,12 +63,10 @@ DAISY_ADD_REDUCE_ACTION_HANDLER(act_end_block, [](DaisyParserPass* pass, SymbolI
     pass->popCurrentScope();
 });
 
-DAISY_ADD_REDUCE_ACTION_HANDLER(act_init_expr_list, [](DaisyParserPass* /*pass*/, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-    auto& node = std::get<std::unique_ptr<ir::Node>>(ss[-1].val);
-    node->push_back(std::move(std::get<std::unique_ptr<ir::Node>>(ss[0].val)));
+DAISY_ADD_REDUCE_ACTION_HANDLER(act_init_expr_list, [](DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
+    pass->getNode(ss[-1].val).push_back(pass->takeNode(ss[0].val));
 });
 
-DAISY_ADD_REDUCE_ACTION_HANDLER(act_append_expr_list, [](DaisyParserPass* /*pass*/, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-    auto& node = std::get<std::unique_ptr<ir::Node>>(ss[-1].val);
-    node->push_back(std::move(std::get<std::unique_ptr<ir::Node>>(ss[2].val)));
+DAISY_ADD_REDUCE_ACTION_HANDLER(act_append_expr_list, [](DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
+    pass->getNode(ss[-1].val).push_back(pass->takeNode(ss[2].val));
 });
@@ -9,7 +9,8 @@ using namespace daisy;
 
 namespace {
 
-std::unordered_map<std::string_view, ir::DataTypeClass> g_built_in_types = {
+// Note: the table outlives compilations, so interned identifiers are not kept
+const std::unordered_map<std::string_view, ir::DataTypeClass> g_built_in_types = {
     {"bool", ir::DataTypeClass::kBool},       {"i8", ir::DataTypeClass::kInt8},
     {"u8", ir::DataTypeClass::kUInt8},        {"i16", ir::DataTypeClass::kInt16},
     {"u16", ir::DataTypeClass::kUInt16},      {"i32", ir::DataTypeClass::kInt32},
@@ -21,48 +22,48 @@ std::unordered_map<std::string_view, ir::DataTypeClass> g_built_in_types = {
 };
 
 void defineConst(DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-    const auto name = std::get<std::string_view>(ss[0].val);
-    auto& const_def_node = pass->getCurrentScope().push_back(
-        std::make_unique<ir::ConstDefNode>(std::string(name), ss[0].loc));
-    const_def_node.setTypeDescriptor(std::move(std::get<ir::TypeDescriptor>(ss[1].val)));
-    const_def_node.push_back(std::move(std::get<std::unique_ptr<ir::Node>>(ss[3].val)));
+    const auto name = ss[0].val.get<Identifier>();
+    auto& const_def_node = pass->getCurrentScope().push_back(std::make_unique<ir::ConstDefNode>(name, ss[0].loc));
+    const_def_node.setTypeDescriptor(std::move(ss[1].val.get<ir::TypeDescriptor>()));
+    const_def_node.push_back(pass->takeNode(ss[3].val));
     if (const_def_node.getTypeDescriptor().isAuto()) {
-        logger::debug(const_def_node.getLoc()).println("defining constant `{}`", name);
+        logger::debug(const_def_node.getLoc()).println("defining constant `{}`", name.getText());
     } else {
         logger::debug(const_def_node.getLoc())
-            .println("defining constant `{}` of type `{}`", name, const_def_node.getTypeDescriptor().getTypeString());
+            .println("defining constant `{}` of type `{}`", name.getText(),
+                     const_def_node.getTypeDescriptor().getTypeString());
     }
     pass->getCurrentScope().getNamespace().defineName(const_def_node);
 }
 
 void defineVariable(DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-    const auto name = std::get<std::string_view>(ss[1].val);
-    auto& var_def_node = pass->getCurrentScope().push_back(
-        std::make_unique<ir::VarDefNode>(std::string(name), ss[1].loc));
-    auto& type_desc = var_def_node.setTypeDescriptor(std::move(std::get<ir::TypeDescriptor>(ss[2].val)));
-    type_desc.setModifiers(std::get<ir::DataTypeModifiers>(ss[0].val));
-    var_def_node.push_back(std::move(std::get<std::unique_ptr<ir::Node>>(ss[4].val)));
+    const auto name = ss[1].val.get<Identifier>();
+    auto& var_def_node = pass->getCurrentScope().push_back(std::make_unique<ir::VarDefNode>(name, ss[1].loc));
+    auto& type_desc = var_def_node.setTypeDescriptor(std::move(ss[2].val.get<ir::TypeDescriptor>()));
+    type_desc.setModifiers(ss[0].val.get<ir::DataTypeModifiers>());
+    var_def_node.push_back(pass->takeNode(ss[4].val));
     if (var_def_node.getTypeDescriptor().isAuto()) {
-        logger::debug(var_def_node.getLoc()).println("defining variable `{}`", name);
+        logger::debug(var_def_node.getLoc()).println("defining variable `{}`", name.getText());
     } else {
         logger::debug(var_def_node.getLoc())
-            .println("defining variable `{}` of type `{}`", name, var_def_node.getTypeDescriptor().getTypeString());
+            .println("defining variable `{}` of type `{}`", name.getText(),
+                     var_def_node.getTypeDescriptor().getTypeString());
     }
     pass->getCurrentScope().getNamespace().defineName(var_def_node);
 }
 
 void makeTypeSpecifier(DaisyParserPass* /*pass*/, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-    const auto name = std::get<std::string_view>(ss[1].val);
-    if (auto it = g_built_in_types.find(name); it != g_built_in_types.end()) {
+    const auto name = ss[1].val.get<Identifier>();
+    if (auto it = g_built_in_types.find(name.getText()); it != g_built_in_types.end()) {
         ss[0].val.emplace<ir::TypeDescriptor>(it->second);
     } else {
-        auto& scope_desc = std::get<ir::ScopeDescriptor>(ss[0].val);
+        auto& scope_desc = ss[0].val.get<ir::ScopeDescriptor>();
         if (scope_desc.getClass() != ir::ScopeClass::kInvalid) {
             if (auto* type_def_node = scope_desc.lookupName<ir::TypeDefNode>(name)) {
                 ss[0].val.emplace<ir::TypeDescriptor>(ir::DataTypeClass::kDefinedDataType, type_def_node);
                 return;
             } else {
-                logger::error(ss[1].loc).println("undeclared type `{}`", name);
+                logger::error(ss[1].loc).println("undeclared type `{}`", name.getText());
             }
         }
         ss[0].val.emplace<ir::TypeDescriptor>();
@@ -73,7 +74,7 @@ void declareFunc(DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
     pass->popCurrentScope();
 
     auto& func_def_node = util::cast<ir::FuncDefNode&>(
-        pass->getCurrentScope().push_back(std::move(std::get<std::unique_ptr<ir::Node>>(ss[1].val))));
+        pass->getCurrentScope().push_back(pass->takeNode(ss[1].val)));
     logger::debug(ss[0].loc + ss[1].loc).println("function `{}` declaration", func_def_node.getProtoString());
 
     ir::FuncProtoCompareResult func_proto_compare_result = ir::FuncProtoCompareResult::kEqual;
@@ -93,15 +94,15 @@ void declareFunc(DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
             existing_def_node->push_back(func_def_node.extract(func_def_node.back()));
             existing_def_node->setDefined(func_def_node.getDefinitionLoc());
         } else {
-            logger::error(func_def_node.getLoc()).println("redefinition of `{}`", func_def_node.getName());
+            logger::error(func_def_node.getLoc()).println("redefinition of `{}`", func_def_node.getName().getText());
             logger::note(existing_def_node->getDefinitionLoc()).println("previous definition is here");
         }
     }
 }
 
-void defineFunc(DaisyParserPass* /*pass*/, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-    auto& func_def_node = util::cast<ir::FuncDefNode&>(*std::get<std::unique_ptr<ir::Node>>(ss[-2].val));
-    func_def_node.push_back(std::move(std::get<std::unique_ptr<ir::Node>>(ss[-1].val)));
+void defineFunc(DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
+    auto& func_def_node = util::cast<ir::FuncDefNode&>(pass->getNode(ss[-2].val));
+    func_def_node.push_back(pass->takeNode(ss[-1].val));
     func_def_node.setDefined(func_def_node.getLoc());
     logger::debug(ss[-3].loc + ss[-2].loc).println("defining function `{}`", func_def_node.getProtoString());
 }
@@ -114,26 +115,27 @@ DAISY_ADD_REDUCE_ACTION_HANDLER(act_make_type_specifier, makeTypeSpecifier);
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_declare_func, declareFunc);
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_define_func, defineFunc);
 
-DAISY_ADD_REDUCE_ACTION_HANDLER(act_set_ret_type, [](DaisyParserPass* /*pass*/, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-    auto& func_def_node = util::cast<ir::FuncDefNode&>(*std::get<std::unique_ptr<ir::Node>>(ss[0].val));
-    func_def_node.setTypeDescriptor(std::move(std::get<ir::TypeDescriptor>(ss[5].val)));
+DAISY_ADD_REDUCE_ACTION_HANDLER(act_set_ret_type, [](DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
+    auto& func_def_node = util::cast<ir::FuncDefNode&>(pass->getNode(ss[0].val));
+    func_def_node.setTypeDescriptor(std::move(ss[5].val.get<ir::TypeDescriptor>()));
 });
 
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_add_func_formal_arg, [](DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
     auto& formal_arg_def = pass->getCurrentScope().push_back(
-        std::make_unique<ir::DefNode>(std::string(std::get<std::string_view>(ss[1].val)), ss[1].loc));
-    auto& type_desc = formal_arg_def.setTypeDescriptor(std::get<ir::TypeDescriptor>(ss[3].val));
-    type_desc.setModifiers(std::get<ir::DataTypeModifiers>(ss[0].val));
+        std::make_unique<ir::DefNode>(ss[1].val.get<Identifier>(), ss[1].loc));
+    auto& type_desc = formal_arg_def.setTypeDescriptor(ss[3].val.get<ir::TypeDescriptor>());
+    type_desc.setModifiers(ss[0].val.get<ir::DataTypeModifiers>());
 });
 
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_begin_func_decl, [](DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-    pass->setCurrentScope(*ss[-2].val.emplace<std::unique_ptr<ir::Node>>(std::make_unique<ir::FuncDefNode>(
-        std::string(std::get<std::string_view>(ss[-2].val)), pass->getCurrentScope(), ss[-2].loc)));
+    pass->setCurrentScope(pass->setNode(ss[-2].val, std::make_unique<ir::FuncDefNode>(ss[-2].val.get<Identifier>(),
+                                                                                      pass->getCurrentScope(),
+                                                                                      ss[-2].loc)));
 });
 
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_definition_type_specifier,
                                 [](DaisyParserPass* /*pass*/, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-                                    ss[0].val = std::move(std::get<ir::TypeDescriptor>(ss[1].val));
+                                    ss[0].val = ss[1].val.get<ir::TypeDescriptor>();
                                 });
 
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_no_type_specifier, [](DaisyParserPass* /*pass*/, SymbolInfo* ss, SymbolLoc& loc) {
@@ -159,11 +161,11 @@ DAISY_ADD_REDUCE_ACTION_HANDLER(act_mutable_reference_type_modifier,
 
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_ret_type_specifier, [](DaisyParserPass* /*pass*/, SymbolInfo* ss,
                                                            SymbolLoc& /*loc*/) {
-    auto& type_desc = ss[0].val.emplace<ir::TypeDescriptor>(std::move(std::get<ir::TypeDescriptor>(ss[2].val)));
-    type_desc.setModifiers(std::get<ir::DataTypeModifiers>(ss[1].val));
+    auto& type_desc = ss[0].val.emplace<ir::TypeDescriptor>(std::move(ss[2].val.get<ir::TypeDescriptor>()));
+    type_desc.setModifiers(ss[1].val.get<ir::DataTypeModifiers>());
 });
 
 DAISY_ADD_REDUCE_ACTION_HANDLER(act_ret_type_modifier, [](DaisyParserPass* /*pass*/, SymbolInfo* ss,
                                                           SymbolLoc& /*loc*/) {
-    ss[0].val.emplace<ir::TypeDescriptor>().setModifiers(std::get<ir::DataTypeModifiers>(ss[1].val));
+    ss[0].val.emplace<ir::TypeDescriptor>().setModifiers(ss[1].val.get<ir::DataTypeModifiers>());
 });
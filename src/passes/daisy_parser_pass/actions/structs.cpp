@@ -9,22 +9,22 @@ namespace {
 
 void beginStructDef(DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
     auto& struct_def_node = pass->getCurrentScope().push_back(std::make_unique<ir::StructDefNode>(
-        std::string(std::get<std::string_view>(ss[-2].val)), pass->getCurrentScope(), ss[-2].loc));
+        ss[-2].val.get<Identifier>(), pass->getCurrentScope(), ss[-2].loc));
     pass->getCurrentScope().getNamespace().defineName(struct_def_node);
     pass->setCurrentScope(struct_def_node);
 }
 
 void defineField(DaisyParserPass* pass, SymbolInfo* ss, SymbolLoc& /*loc*/) {
-    const auto name = std::get<std::string_view>(ss[1].val);
-    auto& field_def_node = pass->getCurrentScope().push_back(
-        std::make_unique<ir::VarDefNode>(std::string(name), ss[1].loc));
-    auto& type_desc = field_def_node.setTypeDescriptor(std::move(std::get<ir::TypeDescriptor>(ss[3].val)));
-    type_desc.setModifiers(std::get<ir::DataTypeModifiers>(ss[0].val));
+    const auto name = ss[1].val.get<Identifier>();
+    auto& field_def_node = pass->getCurrentScope().push_back(std::make_unique<ir::VarDefNode>(name, ss[1].loc));
+    auto& type_desc = field_def_node.setTypeDescriptor(std::move(ss[3].val.get<ir::TypeDescriptor>()));
+    type_desc.setModifiers(ss[0].val.get<ir::DataTypeModifiers>());
     if (field_def_node.getTypeDescriptor().isAuto()) {
-        logger::debug(field_def_node.getLoc()).println("defining field `{}`", name);
+        logger::debug(field_def_node.getLoc()).println("defining field `{}`", name.getText());
     } else {
         logger::debug(field_def_node.getLoc())
-            .println("defining field `{}` of type `{}`", name, field_def_node.getTypeDescriptor().getTypeString());
+            .println("defining field `{}` of type `{}`", name.getText(),
+                     field_def_node.getTypeDescriptor().getTypeString());
     }
     pass->getCurrentScope().getNamespace().defineName(field_def_node);
 }
@@ -1,11 +1,17 @@
 #include "daisy_parser_pass.h"
 
+#include "ctx/include_prefetcher.h"
+#include "keywords.h"
 #include "logger.h"
+#include "pass_stats.h"
 #include "text_utils.h"
+#include "util/raii_cleaner.h"
 
-#include "uxs/io/filebuf.h"
-
+#include <algorithm>
+#include <cstring>
+#include <exception>
 #include <filesystem>
+#include <utility>
 
 namespace lex_detail {
 #include "lex_analyzer.inl"
@@ -23,18 +29,16 @@ DAISY_ADD_PASS(DaisyParserPass);
 /*static*/ const PreprocDirectiveParser* PreprocDirectiveParser::first_avail = nullptr;
 
 namespace {
-std::unordered_map<std::string_view, int> g_keywords = {
-    {"namespace", parser_detail::tt_namespace},
-    {"const", parser_detail::tt_const},
-    {"let", parser_detail::tt_let},
-    {"func", parser_detail::tt_func},
-    {"if", parser_detail::tt_if},
-    {"else", parser_detail::tt_else},
-    {"loop", parser_detail::tt_loop},
-    {"while", parser_detail::tt_while},
-    {"struct", parser_detail::tt_struct},
-    {"mut", parser_detail::tt_mut},
-};
+constexpr util::keyword_table g_keywords(kKeywords);
+
+// Text is searched for '\0' by windows of this size when the lexer is closer than the margin to the unchecked text
+constexpr std::size_t kTextCheckWindow = 1024 * 1024;
+constexpr std::ptrdiff_t kTextCheckMargin = kTextCheckWindow / 2;
+
+const std::filesystem::path& getCurrentPath() {
+    static const std::filesystem::path current_path = std::filesystem::current_path();
+    return current_path;
+}
 }
 
 void DaisyParserPass::configure() {
@@ -51,34 +55,31 @@ void DaisyParserPass::cleanup() {
     input_ctx_stack_.clear();
     lex_state_stack_.clear();
     if_section_stack_.clear();
+    nodes_.clear();
+    free_node_slots_.clear();
+    string_pieces_.clear();
+    token_ring_first_ = token_ring_last_ = 0;
 }
 
 PassResult DaisyParserPass::run(CompilationContext& ctx) {
     uxs::inline_basic_dynbuffer<int, 1> parser_state_stack;
     std::vector<SymbolInfo> symbol_stack;
 
-    ctx_ = &ctx;
     error_status_ = 0;
-    lex_state_stack_.reserve(256);
     parser_state_stack.reserve(1024);
     symbol_stack.reserve(1024);
 
-    ctx_->ir_root = std::make_unique<ir::RootNode>();
-    current_scope_ = ctx_->ir_root.get();
-
-    defineBuiltinMacros();
+    ctx.ir_root = std::make_unique<ir::RootNode>();
+    current_scope_ = ctx.ir_root.get();
 
-    // Create main source file input context
-    const auto* src_file = pushInputFile(ctx.file_name, {});
-    if (!src_file) {
-        logger::fatal().println("could not open input file `{}`", ctx.file_name);
-        return PassResult::kFatalError;
-    }
+    if (!beginInput(ctx)) { return PassResult::kFatalError; }
+    if (ctx.pipelined_parsing) { startTokenProducer(); }
 
-    lex_state_stack_.push_back(lex_detail::sc_initial);
+    // Note: tokens which are lexed but not taken are discarded on any exit, and the producer thread is stopped
+    util::raii_cleaner discard_tokens([this]() { discardTokens(); });
 
     // Parse input file
-    int tt = lex(la_tkn_);
+    int tt = takeToken(la_tkn_);
     parser_state_stack.push_back(parser_detail::sc_initial);  // Push initial state
     while (true) {
         parser_state_stack.reserve(1);
@@ -96,7 +97,7 @@ PassResult DaisyParserPass::run(CompilationContext& ctx) {
                 if (error_status_ == kAcceptToRestore) {  // Discard lookahead symbol
                     if (tt == parser_detail::tt_end_of_file) { return PassResult::kError; }
                     symbol_stack.emplace_back(std::move(la_tkn_));
-                    tt = lex(la_tkn_);
+                    tt = takeToken(la_tkn_);
                     ++rlen;
                 }
                 error_status_ = kAcceptToRestore;
@@ -112,27 +113,27 @@ PassResult DaisyParserPass::run(CompilationContext& ctx) {
         } else if (tt != parser_detail::tt_end_of_file) {
             if (logger::g_debug_level >= 3) {
                 if (tt == parser_detail::tt_id) {
-                    logger::debug(la_tkn_.loc, true).println("id: {}", std::get<std::string_view>(la_tkn_.val));
+                    logger::debug(la_tkn_.loc, true).println("id: {}", la_tkn_.val.get<Identifier>().getText());
                 } else if (tt == parser_detail::tt_string_literal) {
-                    logger::debug(la_tkn_.loc, true).println("string: {:?}", std::get<std::string>(la_tkn_.val));
+                    logger::debug(la_tkn_.loc, true).println("string: {:?}", la_tkn_.val.get<std::string_view>());
                 } else if (tt == parser_detail::tt_int_literal) {
-                    if (std::get<ir::IntConst>(la_tkn_.val).isSigned()) {
+                    if (la_tkn_.val.get<ir::IntConst>().isSigned()) {
                         logger::debug(la_tkn_.loc, true)
-                            .println("integer number: {}", std::get<ir::IntConst>(la_tkn_.val).getValue<std::int64_t>());
+                            .println("integer number: {}", la_tkn_.val.get<ir::IntConst>().getValue<std::int64_t>());
                     } else {
                         logger::debug(la_tkn_.loc, true)
                             .println("integer number: {}",
-                                     std::get<ir::IntConst>(la_tkn_.val).getValue<std::uint64_t>());
+                                     la_tkn_.val.get<ir::IntConst>().getValue<std::uint64_t>());
                     }
                 } else if (tt == parser_detail::tt_float_literal) {
                     logger::debug(la_tkn_.loc, true)
-                        .println("float number: {}", std::get<ir::FloatConst>(la_tkn_.val).getValue<double>());
+                        .println("float number: {}", la_tkn_.val.get<ir::FloatConst>().getValue<double>());
                 } else {
                     logger::debug(la_tkn_.loc, true).println("token");
                 }
             }
             symbol_stack.emplace_back(std::move(la_tkn_));
-            tt = lex(la_tkn_);
+            tt = takeToken(la_tkn_);
             if (error_status_) { --error_status_; }
         } else {
             break;
@@ -143,15 +144,195 @@ PassResult DaisyParserPass::run(CompilationContext& ctx) {
     return ctx.error_count == 0 ? PassResult::kSuccess : PassResult::kError;
 }
 
+bool DaisyParserPass::beginInput(CompilationContext& ctx) {
+    ctx_ = &ctx;
+    is_end_of_file_taken_ = false;
+    lex_state_stack_.reserve(256);
+
+    defineBuiltinMacros();
+
+    // Create main source file input context
+    if (!pushInputFile(ctx.file_name, {})) {
+        logger::fatal().println("could not open input file `{}`", ctx.file_name);
+        return false;
+    }
+
+    lex_state_stack_.push_back(lex_detail::sc_initial);
+    return true;
+}
+
+void DaisyParserPass::lexBufferedToken(BufferedToken& buffered) {
+    buffered.diag.clear();
+    logger::OutputCapture capture(buffered.diag);
+    const auto counts = logger::getThreadMessageCounts();
+    buffered.tt = lex(buffered.tkn);
+    buffered.error_count = logger::getThreadMessageCounts().errors - counts.errors;
+    buffered.warning_count = logger::getThreadMessageCounts().warnings - counts.warnings;
+}
+
+int DaisyParserPass::takeToken(SymbolInfo& tkn) {
+    BufferedToken* buffered = nullptr;
+    if (token_queue_) {
+        buffered = &token_queue_->front();
+    } else {
+        if (token_ring_first_ == token_ring_last_) { fillTokenRing(); }
+        buffered = &token_ring_[token_ring_first_ % kTokenRingSize];
+    }
+    if (!buffered->diag.empty()) { logger::writeOutput(buffered->diag); }
+    tkn = buffered->tkn;
+    const int tt = buffered->tt;
+    if (token_queue_) {
+        token_queue_->pop_front();
+    } else {
+        ++token_ring_first_;
+    }
+    if (tt == parser_detail::tt_end_of_file) {
+        is_end_of_file_taken_ = true;
+        if (token_queue_) {
+            stopTokenProducer();
+            // Rethrow the exception which has stopped the producer where lexing would throw it in sequential mode
+            if (producer_error_) { std::rethrow_exception(std::exchange(producer_error_, nullptr)); }
+        }
+    }
+    return tt;
+}
+
+void DaisyParserPass::fillTokenRing() {
+    assert(token_ring_first_ == token_ring_last_);
+    // Note: the batch ends with the end of file, so the analyzer never runs past it
+    do {
+        auto& buffered = token_ring_[token_ring_last_++ % kTokenRingSize];
+        lexBufferedToken(buffered);
+        if (buffered.tt == parser_detail::tt_end_of_file) { break; }
+    } while (token_ring_last_ - token_ring_first_ < kTokenRingSize);
+}
+
+void DaisyParserPass::discardTokens() {
+    // Note: the parser stops before taking these tokens, so their diagnostics are neither written nor counted
+    auto discard = [this](const BufferedToken& buffered) {
+        ctx_->error_count -= buffered.error_count;
+        ctx_->warning_count -= buffered.warning_count;
+    };
+    for (; token_ring_first_ != token_ring_last_; ++token_ring_first_) {
+        discard(token_ring_[token_ring_first_ % kTokenRingSize]);
+    }
+    if (!token_queue_) { return; }
+    if (!is_end_of_file_taken_) {
+        // The producer finishes its current token and ends the stream
+        stop_producer_.store(true, std::memory_order_relaxed);
+        for (bool is_last = false; !is_last; token_queue_->pop_front()) {
+            const auto& buffered = token_queue_->front();
+            discard(buffered);
+            is_last = buffered.tt == parser_detail::tt_end_of_file;
+        }
+    }
+    stopTokenProducer();
+    producer_error_ = nullptr;
+}
+
+void DaisyParserPass::startTokenProducer() {
+    token_queue_ = std::make_unique<TokenQueue>();
+    stop_producer_.store(false, std::memory_order_relaxed);
+    producer_error_ = nullptr;
+    // Note: CPU time and allocations of the producer are accounted to the statistics of this pass
+    PassStatsScope* stats_scope = ctx_->pass_stats ? PassStatsScope::getCurrent() : nullptr;
+    producer_thread_ = std::thread([this, debug_level = logger::g_debug_level, stats_scope]() {
+        PassStatsHelperScope stats_helper_scope(stats_scope);
+        produceTokens(debug_level);
+    });
+}
+
+void DaisyParserPass::stopTokenProducer() {
+    // Note: the producer has pushed the end of file already
+    producer_thread_.join();
+    token_queue_.reset();
+}
+
+void DaisyParserPass::produceTokens(unsigned debug_level) {
+    // Note: only the lexical analyzer and the preprocessor run on this thread, the parser and reduce actions never
+    // touch their state; messages of each token are captured and written by the parser thread. Taken tokens refer to
+    // location contexts and macro definitions, which stay alive and unchanged until the end of compilation, see
+    // `CompilationContext::retired_macro_defs`
+    logger::g_debug_level = debug_level;
+    bool is_last = false;
+    do {
+        auto& buffered = token_queue_->back();
+        if (!stop_producer_.load(std::memory_order_relaxed)) {
+            try {
+                lexBufferedToken(buffered);
+            } catch (...) {
+                producer_error_ = std::current_exception();
+                buffered.tt = parser_detail::tt_end_of_file;
+                buffered.error_count = buffered.warning_count = 0;
+            }
+        } else {
+            buffered.tt = parser_detail::tt_end_of_file;
+            buffered.diag.clear();
+            buffered.error_count = buffered.warning_count = 0;
+        }
+        is_last = buffered.tt == parser_detail::tt_end_of_file;
+        token_queue_->push_back();
+    } while (!is_last);
+}
+
 int DaisyParserPass::lex(SymbolInfo& tkn, bool* leading_ws) {
-    std::string txt;
     auto* in_ctx = &getInputContext();
 
+    // Note: a string literal without escape sequences and line wraps is a view to the source text, other ones are
+    // built in `literal_buf_` and stored to the string arena of compilation context
+    std::string_view literal;
+    bool is_literal_buffered = false;
+    auto literal_buf = [this, &literal, &is_literal_buffered]() -> std::string& {
+        if (!is_literal_buffered) { literal_buf_.assign(literal), is_literal_buffered = true; }
+        return literal_buf_;
+    };
+    auto take_literal = [this, &literal, &is_literal_buffered]() {
+        return is_literal_buffered ? ctx_->literal_strings.store(literal_buf_) : literal;
+    };
+
     auto reset_token_loc = [&tkn](const auto& in_ctx) {
         tkn.loc.loc_ctx = in_ctx.loc_ctx;
         tkn.loc.first = in_ctx.text.pos;
     };
 
+    // Note: lexemes are cached only for file text outside of directives, where the analyzer always starts in the
+    // initial state and the input is limited by the end of file
+    auto is_lexeme_cacheable = [this](const InputContext& in_ctx) {
+        return in_ctx.lexeme_base && in_ctx.flags == InputContext::Flags::kNone &&
+               lex_state_stack_.back() == lex_detail::sc_initial;
+    };
+
+    // Values of replayed lexemes are taken from the cache, values of recorded ones are stored to the cache unless
+    // their evaluation has reported a message, which must be reported again
+    const LexemeCache::Lexeme* cached = nullptr;
+    LexemeCache* recorded = nullptr;
+    std::size_t recorded_index = 0;
+    auto has_cached_value = [&cached]() { return cached && cached->value != LexemeCache::kNoValue; };
+    auto record_value = [&recorded, &recorded_index](std::size_t value, bool is_keyword = false) {
+        if (recorded) {
+            recorded->lexemes[recorded_index].value = static_cast<std::uint32_t>(value);
+            recorded->lexemes[recorded_index].is_keyword = is_keyword;
+        }
+    };
+    auto get_message_count = []() {
+        const auto counts = logger::getThreadMessageCounts();
+        return counts.errors + counts.warnings;
+    };
+    auto lex_int_literal = [&](unsigned base, std::string_view digits) {
+        if (has_cached_value()) {
+            tkn.val = in_ctx->lexeme_cache->int_consts[cached->value];
+        } else {
+            const unsigned msg_count = get_message_count();
+            const auto val = ir::IntConst::fromString(base, tkn.loc, digits);
+            if (recorded && get_message_count() == msg_count) {
+                record_value(recorded->int_consts.size());
+                recorded->int_consts.push_back(val);
+            }
+            tkn.val = val;
+        }
+        return parser_detail::tt_int_literal;
+    };
+
     reset_token_loc(*in_ctx);
 
     while (true) {
@@ -159,8 +340,21 @@ int DaisyParserPass::lex(SymbolInfo& tkn, bool* leading_ws) {
         std::size_t llen = 0;
         const char* first = in_ctx->text.first;
         const char* lexeme = first;
+        cached = nullptr, recorded = nullptr;
         while (true) {
             int lex_flags = at_beginning_of_line_;
+            if (first == lexeme && in_ctx->unchecked_pos && in_ctx->unchecked_pos - first < kTextCheckMargin) {
+                checkTextEnd(*in_ctx, first);
+                first = lexeme = in_ctx->text.first;
+            }
+            if (first == lexeme && in_ctx->lexeme_cache && is_lexeme_cacheable(*in_ctx)) {
+                cached = in_ctx->lexeme_cache->find(static_cast<std::uint32_t>(first - in_ctx->lexeme_base),
+                                                    lex_flags != 0, in_ctx->next_lexeme);
+                if (cached) {
+                    pat = cached->pat, llen = cached->length;
+                    break;
+                }
+            }
             const char* last = in_ctx->text.last;
             if (lex_state_stack_.avail() < static_cast<std::size_t>(last - first)) {
                 last = first + lex_state_stack_.avail();
@@ -179,7 +373,7 @@ int DaisyParserPass::lex(SymbolInfo& tkn, bool* leading_ws) {
             } else {  // Input buffer is over
                 if (lex_state_stack_.back() == lex_detail::sc_string) {
                     logger::warning(tkn.loc).println("unterminated string literal");
-                    tkn.val = std::move(txt);
+                    tkn.val = take_literal();
                     lex_state_stack_.back() = lex_detail::sc_initial;
                     return parser_detail::tt_string_literal;
                 }
@@ -191,6 +385,12 @@ int DaisyParserPass::lex(SymbolInfo& tkn, bool* leading_ws) {
                     logger::warning(if_section_stack_.front().loc).println("`#if` without `#endif`");
                     popIfSection();
                 }
+                if (in_ctx->guard_state == InputContext::IncludeGuardState::kAfterGuard) {
+                    in_ctx->loc_ctx->file->getOrigin().guard_macro = in_ctx->guard_macro;
+                }
+                if (in_ctx->recorded_lexemes) {
+                    in_ctx->loc_ctx->file->source->publishLexemeCache(std::move(in_ctx->recorded_lexemes));
+                }
                 // Input context stack is empty - end of compilation unit
                 if (popInputContext()) { return parser_detail::tt_end_of_file; }
                 reset_token_loc(*(in_ctx = &getInputContext()));
@@ -199,33 +399,64 @@ int DaisyParserPass::lex(SymbolInfo& tkn, bool* leading_ws) {
             }
         }
 
+        if (!cached && in_ctx->recorded_lexemes && is_lexeme_cacheable(*in_ctx)) {
+            recorded = in_ctx->recorded_lexemes.get();
+            recorded_index = recorded->lexemes.size();
+            recorded->lexemes.push_back(LexemeCache::Lexeme{static_cast<std::uint32_t>(lexeme - in_ctx->lexeme_base),
+                                                            static_cast<std::uint32_t>(llen), LexemeCache::kNoValue,
+                                                            static_cast<std::uint8_t>(pat), at_beginning_of_line_ != 0,
+                                                            false});
+        }
+
         at_beginning_of_line_ = 0;
         in_ctx->text.first += llen, in_ctx->text.pos.col += llen;
         tkn.loc.last = {in_ctx->text.pos.ln, in_ctx->text.pos.col - 1};
 
+        // Release consumed text of a streamed file keeping the last window
+        if (in_ctx->release_pos &&
+            static_cast<std::size_t>(in_ctx->text.first - in_ctx->release_pos) >= 2 * SourceFile::kStreamingWindow) {
+            const char* release_last = in_ctx->text.first - SourceFile::kStreamingWindow;
+            in_ctx->loc_ctx->file->source->releasePages(in_ctx->release_pos, release_last);
+            in_ctx->release_pos = release_last;
+        }
+
+        if ((in_ctx->guard_state == InputContext::IncludeGuardState::kStart ||
+             in_ctx->guard_state == InputContext::IncludeGuardState::kAfterGuard) &&
+            !(in_ctx->flags & InputContext::Flags::kPreprocDirective)) {
+            switch (pat) {
+                case lex_detail::pat_comment1:
+                case lex_detail::pat_comment2:
+                case lex_detail::pat_nl:
+                case lex_detail::pat_fake_nl:
+                case lex_detail::pat_whitespace:
+                case lex_detail::pat_sharp: break;  // Note: directives are tracked separately
+                default: in_ctx->guard_state = InputContext::IncludeGuardState::kNotGuarded; break;
+            }
+        }
+
         switch (pat) {
             // ------ escape sequences
-            case lex_detail::pat_escape_a: txt.push_back('\a'); break;
-            case lex_detail::pat_escape_b: txt.push_back('\b'); break;
-            case lex_detail::pat_escape_f: txt.push_back('\f'); break;
-            case lex_detail::pat_escape_r: txt.push_back('\r'); break;
-            case lex_detail::pat_escape_n: txt.push_back('\n'); break;
-            case lex_detail::pat_escape_t: txt.push_back('\t'); break;
-            case lex_detail::pat_escape_v: txt.push_back('\v'); break;
+            case lex_detail::pat_escape_a: literal_buf().push_back('\a'); break;
+            case lex_detail::pat_escape_b: literal_buf().push_back('\b'); break;
+            case lex_detail::pat_escape_f: literal_buf().push_back('\f'); break;
+            case lex_detail::pat_escape_r: literal_buf().push_back('\r'); break;
+            case lex_detail::pat_escape_n: literal_buf().push_back('\n'); break;
+            case lex_detail::pat_escape_t: literal_buf().push_back('\t'); break;
+            case lex_detail::pat_escape_v: literal_buf().push_back('\v'); break;
             case lex_detail::pat_escape_other: {
                 logger::warning(tkn.loc).println("unknown escape sequence");
-                txt.push_back(lexeme[1]);
+                literal_buf().push_back(lexeme[1]);
             } break;
             case lex_detail::pat_escape_hex: {
                 char escape = uxs::dig_v(lexeme[2]);
                 if (llen > 3) { escape = (escape << 4) + uxs::dig_v(lexeme[3]); }
-                txt.push_back(escape);
+                literal_buf().push_back(escape);
             } break;
             case lex_detail::pat_escape_oct: {
                 char escape = uxs::dig_v(lexeme[1]);
                 if (llen > 2) { escape = (escape << 3) + uxs::dig_v(lexeme[2]); }
                 if (llen > 3) { escape = (escape << 3) + uxs::dig_v(lexeme[3]); }
-                txt.push_back(escape);
+                literal_buf().push_back(escape);
             } break;
 
             // ------ operators
@@ -251,15 +482,21 @@ int DaisyParserPass::lex(SymbolInfo& tkn, bool* leading_ws) {
 
             // ------ string literal
             case lex_detail::pat_string: lex_state_stack_.back() = lex_detail::sc_string; break;
-            case lex_detail::pat_string_seq: txt.append(lexeme, llen); break;
+            case lex_detail::pat_string_seq: {
+                if (!is_literal_buffered && (literal.empty() || literal.data() + literal.size() == lexeme)) {
+                    literal = std::string_view(literal.empty() ? lexeme : literal.data(), literal.size() + llen);
+                } else {
+                    literal_buf().append(lexeme, llen);
+                }
+            } break;
             case lex_detail::pat_string_ln_wrap: in_ctx->text.pos.nextLn(); break;  // Skip '\n'
             case lex_detail::pat_string_nl: {
                 logger::warning(SymbolLoc(tkn.loc.loc_ctx, tkn.loc.last)).println("line break in string literal");
-                txt.push_back('\n');
+                literal_buf().push_back('\n');
                 in_ctx->text.pos.nextLn();
             } break;
             case lex_detail::pat_string_close: {
-                tkn.val = std::move(txt);
+                tkn.val = take_literal();
                 lex_state_stack_.back() = lex_detail::sc_initial;
                 return parser_detail::tt_string_literal;
             } break;
@@ -269,30 +506,45 @@ int DaisyParserPass::lex(SymbolInfo& tkn, bool* leading_ws) {
             case lex_detail::pat_false_literal: tkn.val = false; return parser_detail::tt_bool_literal;
 
             // ------ numerical literals
-            case lex_detail::pat_bin_literal: {
-                tkn.val = ir::IntConst::fromString(2, tkn.loc, std::string_view(lexeme + 2, llen - 2));
-                return parser_detail::tt_int_literal;
-            } break;
-            case lex_detail::pat_oct_literal: {
-                tkn.val = ir::IntConst::fromString(8, tkn.loc, std::string_view(lexeme, llen));
-                return parser_detail::tt_int_literal;
-            } break;
-            case lex_detail::pat_dec_literal: {
-                tkn.val = ir::IntConst::fromString(10, tkn.loc, std::string_view(lexeme, llen));
-                return parser_detail::tt_int_literal;
-            } break;
-            case lex_detail::pat_hex_literal: {
-                tkn.val = ir::IntConst::fromString(16, tkn.loc, std::string_view(lexeme + 2, llen - 2));
-                return parser_detail::tt_int_literal;
-            } break;
+            case lex_detail::pat_bin_literal: return lex_int_literal(2, std::string_view(lexeme + 2, llen - 2));
+            case lex_detail::pat_oct_literal: return lex_int_literal(8, std::string_view(lexeme, llen));
+            case lex_detail::pat_dec_literal: return lex_int_literal(10, std::string_view(lexeme, llen));
+            case lex_detail::pat_hex_literal: return lex_int_literal(16, std::string_view(lexeme + 2, llen - 2));
             case lex_detail::pat_float_literal: {
-                tkn.val = ir::FloatConst::fromString(tkn.loc, std::string_view(lexeme, llen));
+                if (has_cached_value()) {
+                    tkn.val = in_ctx->lexeme_cache->float_consts[cached->value];
+                } else {
+                    const unsigned msg_count = get_message_count();
+                    const auto val = ir::FloatConst::fromString(tkn.loc, std::string_view(lexeme, llen));
+                    if (recorded && get_message_count() == msg_count) {
+                        record_value(recorded->float_consts.size());
+                        recorded->float_consts.push_back(val);
+                    }
+                    tkn.val = val;
+                }
                 return parser_detail::tt_float_literal;
             } break;
 
             // ------ identifiers
             case lex_detail::pat_id: {
-                auto id = std::string_view(lexeme, llen);
+                Identifier id;
+                if (has_cached_value()) {
+                    if (cached->is_keyword) { return static_cast<int>(cached->value); }
+                    id = in_ctx->lexeme_cache->ids[cached->value];
+                } else {
+                    // Note: keywords can't be macro or macro argument identifiers, so they are not interned
+                    if (!(in_ctx->flags & InputContext::Flags::kPreprocDirective)) {
+                        if (int tt = g_keywords.find(std::string_view(lexeme, llen))) {
+                            record_value(static_cast<std::size_t>(tt), true);
+                            return tt;
+                        }
+                    }
+                    id = Identifier(std::string_view(lexeme, llen));
+                    if (recorded) {
+                        record_value(recorded->ids.size());
+                        recorded->ids.push_back(id);
+                    }
+                }
                 if (const auto* macro_exp = in_ctx->macro_expansion) {
                     assert(macro_exp->macro_def);
                     const auto& macro_def = *macro_exp->macro_def;
@@ -309,9 +561,6 @@ int DaisyParserPass::lex(SymbolInfo& tkn, bool* leading_ws) {
                         break;
                     }
                 }
-                if (!(in_ctx->flags & InputContext::Flags::kPreprocDirective)) {
-                    if (auto it = g_keywords.find(id); it != g_keywords.end()) { return it->second; }
-                }
                 tkn.val = id;
                 return parser_detail::tt_id;
             } break;
@@ -369,52 +618,119 @@ int DaisyParserPass::lex(SymbolInfo& tkn, bool* leading_ws) {
 
 const InputFileInfo* DaisyParserPass::pushInputFile(std::string_view file_path, const SymbolLoc& expansion_loc) {
     std::filesystem::path path(file_path);
-    if (path.is_relative()) { path = (std::filesystem::current_path() / path).lexically_normal(); }
+    if (path.is_relative()) {
+        // Note: the working directory of a compile server request differs from the server's one
+        path = ctx_->working_dir.empty() ? getCurrentPath() / path : std::filesystem::path(ctx_->working_dir) / path;
+        path = path.lexically_normal();
+    }
 
     std::string normal_path = path.generic_string();
     auto it = ctx_->input_files.find(normal_path);
     InputFileInfo* file_info = it != ctx_->input_files.end() ? it->second.get() : nullptr;
 
     if (!file_info) {
-        if (!std::filesystem::exists(path)) { return nullptr; }
-
-        uxs::filebuf ifile(normal_path.c_str(), "r");
-        if (!ifile) { return nullptr; }
-
-        auto pos = ifile.seek(0, uxs::seekdir::end);
-        if (pos == uxs::iobuf::traits_type::npos()) { return nullptr; }
-
-        file_info = ctx_->input_files
-                        .emplace(std::move(normal_path), std::make_unique<InputFileInfo>(ctx_, std::string(file_path)))
-                        .first->second.get();
-
-        std::size_t file_sz = static_cast<std::size_t>(pos);
-        file_info->text = std::make_unique<char[]>(file_sz);
-        ifile.seek(0);
-        std::size_t n_read = ifile.read(std::span(file_info->text.get(), file_sz));
-
-        auto get_next_line = [](const char* text, const char* boundary) {
-            return std::string_view(text,
-                                    std::find_if(text, boundary, [](char ch) { return !ch || ch == '\n'; }) - text);
-        };
-
-        const char* boundary = file_info->text.get() + n_read;
-        const char* last = file_info->text.get() +
-                           file_info->text_lines.emplace_back(get_next_line(file_info->text.get(), boundary)).size();
-        while (last != boundary && *last) {
-            last += file_info->text_lines.emplace_back(get_next_line(++last, boundary)).size();
+        FileId file_id;
+        auto source = SourceFileCache::getInstance().getFile(normal_path, &file_id);
+        if (!source) {
+            ctx_->missing_files.emplace_back(std::move(normal_path));
+            return nullptr;
         }
+        if (ctx_->prefetcher) { ctx_->prefetcher->prefetchIncludes(normal_path, source); }
+
+        auto new_it = ctx_->input_files
+                          .emplace(std::move(normal_path),
+                                   std::make_unique<InputFileInfo>(ctx_, std::string(file_path), std::move(source)))
+                          .first;
+        file_info = new_it->second.get();
+        file_info->file_id = file_id;
+        ctx_->dependencies.push_back(new_it->first);
+
+        // The same file can be reached by another path, e.g. through a symbolic link
+        auto [it, is_new] = ctx_->input_files_by_id.emplace(file_id, file_info);
+        if (!is_new) { file_info->origin = it->second; }
+    }
 
-        file_info->text_size = last - file_info->text.get();
+    // Skip the file without creating input and location contexts if it is `#pragma once` or include-guarded one
+    const auto& origin = file_info->getOrigin();
+    if (!!(origin.flags & InputFileInfo::Flags::kOnce) ||
+        (!origin.guard_macro.empty() && ctx_->macro_defs.find(origin.guard_macro) != ctx_->macro_defs.end())) {
+        return file_info;
     }
 
-    pushInputContext(
+    auto& in_ctx = pushInputContext(
         std::make_unique<InputContext>(file_info->getText(), &newLocationContext(file_info, expansion_loc)));
+    in_ctx.guard_state = InputContext::IncludeGuardState::kStart;
+    if (in_ctx.text.first != in_ctx.text.last) { in_ctx.unchecked_pos = in_ctx.text.first; }
+    if (file_info->source->isStreamed()) {
+        in_ctx.release_pos = in_ctx.text.first;
+    } else if (ctx_->use_lexeme_cache && file_info->source->text_size <= LexemeCache::kMaxTextSize) {
+        // Note: lexemes of streamed files are not cached to keep memory bounded
+        in_ctx.lexeme_base = in_ctx.text.first;
+        in_ctx.lexeme_cache = file_info->source->getLexemeCache();
+        if (!in_ctx.lexeme_cache) {
+            // Note: lexemes are recorded on the second inclusion, most source files are lexed only once
+            if (file_info->source->addInclusion() > 0) {
+                in_ctx.recorded_lexemes = std::make_unique<LexemeCache>();
+                in_ctx.recorded_lexemes->id_epoch = Identifier::getTableEpoch();
+            }
+        } else if (in_ctx.lexeme_cache->id_epoch != Identifier::getTableEpoch()) {
+            // Note: the cache has been recorded before the identifier table was cleared, so it is not replayed
+            in_ctx.lexeme_cache = nullptr;
+        }
+    }
     at_beginning_of_line_ = lex_detail::flag_at_beg_of_line;
     return file_info;
 }
 
-bool DaisyParserPass::isKeyword(std::string_view id) const { return g_keywords.find(id) != g_keywords.end(); }
+/*static*/ bool DaisyParserPass::isKeyword(std::string_view id) { return g_keywords.find(id) != 0; }
+
+ir::Node& DaisyParserPass::setNode(SymbolVal& val, std::unique_ptr<ir::Node> node) {
+    std::uint32_t index = static_cast<std::uint32_t>(nodes_.size());
+    if (!free_node_slots_.empty()) {
+        index = free_node_slots_.back();
+        free_node_slots_.pop_back();
+        nodes_[index] = std::move(node);
+    } else {
+        nodes_.emplace_back(std::move(node));
+    }
+    val = NodeRef{index};
+    return *nodes_[index];
+}
+
+std::unique_ptr<ir::Node> DaisyParserPass::takeNode(SymbolVal& val) {
+    const std::uint32_t index = val.get<NodeRef>().index;
+    assert(nodes_[index]);
+    free_node_slots_.push_back(index);
+    return std::move(nodes_[index]);
+}
+
+void DaisyParserPass::appendStringPiece(SymbolVal& val, std::string_view piece) {
+    if (const auto* s = val.getIf<std::string_view>()) {
+        const std::string_view first_piece = *s;
+        val = StringPieces{static_cast<std::uint32_t>(string_pieces_.size()), 1};
+        string_pieces_.push_back(first_piece);
+    }
+    auto& pieces = val.get<StringPieces>();
+    if (pieces.first + pieces.count != string_pieces_.size()) {
+        // Note: pieces of a chain are contiguous unless parsing of the chain has been interrupted by an error
+        for (std::uint32_t n = 0; n < pieces.count; ++n) { string_pieces_.push_back(string_pieces_[pieces.first + n]); }
+        pieces.first = static_cast<std::uint32_t>(string_pieces_.size()) - pieces.count;
+    }
+    string_pieces_.push_back(piece), ++pieces.count;
+}
+
+std::string_view DaisyParserPass::takeString(const SymbolVal& val) {
+    if (val.is<std::string_view>()) { return val.get<std::string_view>(); }
+    const auto& pieces = val.get<StringPieces>();
+    const auto first = string_pieces_.begin() + pieces.first, last = first + pieces.count;
+    std::size_t sz = 0;
+    for (auto it = first; it != last; ++it) { sz += it->size(); }
+    char* p = ctx_->joined_strings.allocate(sz);
+    const std::string_view s(p, sz);
+    for (auto it = first; it != last; ++it) { p = std::copy(it->begin(), it->end(), p); }
+    if (pieces.first + pieces.count == string_pieces_.size()) { string_pieces_.resize(pieces.first); }
+    return s;
+}
 
 void DaisyParserPass::ensureEndOfInput(SymbolInfo& tkn) {
     if (lex(tkn) != parser_detail::tt_end_of_input) {
@@ -433,14 +749,24 @@ void DaisyParserPass::parsePreprocessorDirective() {
 
         // Limit input by one line
         skipTillNewLine(text);
+        if (in_ctx.unchecked_pos && text.first > in_ctx.unchecked_pos) {
+            // Note: the line is longer than the checked window, so the text can end inside of it
+            checkTextEnd(in_ctx, text.first);
+            text.first = std::min(text.first, in_ctx.text.last), text.last = in_ctx.text.last;
+        }
         in_ctx.text.last = text.first;
         in_ctx.flags = InputContext::Flags::kPreprocDirective | InputContext::Flags::kStopAtEndOfInput |
                        InputContext::Flags::kDisableMacroExpansion;
 
         SymbolInfo tkn;
         int tt = lex(tkn);  // Parse directive name
+        if (in_ctx.guard_state != InputContext::IncludeGuardState::kNotGuarded) {
+            trackIncludeGuard(in_ctx, tt == parser_detail::tt_id ? tkn.val.get<Identifier>().getText() : "",
+                              in_ctx.text);
+        }
+
         if (tt == parser_detail::tt_id) {
-            auto it = preproc_directive_parsers_.find(std::get<std::string_view>(tkn.val));
+            auto it = preproc_directive_parsers_.find(tkn.val.get<Identifier>().getText());
             if (it != preproc_directive_parsers_.end()) {
                 if (!is_text_disabled || it->second->parse_disabled_text) { it->second->func(this, tkn); }
             } else if (!is_text_disabled) {
@@ -450,6 +776,10 @@ void DaisyParserPass::parsePreprocessorDirective() {
             logger::error(tkn.loc).println("expected preprocessing directive identifier");
         }
 
+        if (in_ctx.guard_state == InputContext::IncludeGuardState::kInsideGuard && !in_ctx.guard_if_section) {
+            in_ctx.guard_if_section = getIfSection();
+        }
+
         if (!!(in_ctx.flags & InputContext::Flags::kSkipFile)) { text.first = text.last; }
         in_ctx.text = text, in_ctx.flags = flags;
 
@@ -459,10 +789,64 @@ void DaisyParserPass::parsePreprocessorDirective() {
         // Eat up all text till the position after single `#` symbol
         // Note: strings and comments are skipped
         skipTillPreprocDirective(in_ctx.text);
+        if (in_ctx.unchecked_pos && in_ctx.text.first > in_ctx.unchecked_pos) {
+            checkTextEnd(in_ctx, in_ctx.text.first);
+        }
         is_text_disabled = true;
     } while (in_ctx.text.first != in_ctx.text.last);
 }
 
+void DaisyParserPass::checkTextEnd(InputContext& in_ctx, const char* pos) {
+    // Text of a file ends at the first '\0', which is searched a window ahead of `pos`, so a file is never scanned as
+    // a whole before lexing. Text skipped beyond the window, e.g. a very long comment, is searched afterwards, and
+    // the input is cut at the found '\0'
+    const char* last = std::max(pos, in_ctx.unchecked_pos);
+    // Note: input limited by a directive line ends before the unchecked text
+    if (last > in_ctx.text.last) { return; }
+    last += std::min(static_cast<std::size_t>(in_ctx.text.last - last), kTextCheckWindow);
+    if (last == in_ctx.unchecked_pos) { return; }
+    if (const void* p = std::memchr(in_ctx.unchecked_pos, '\0', last - in_ctx.unchecked_pos)) {
+        in_ctx.text.last = static_cast<const char*>(p);
+        in_ctx.text.first = std::min(in_ctx.text.first, in_ctx.text.last);
+        in_ctx.unchecked_pos = nullptr;
+    } else {
+        in_ctx.unchecked_pos = last != in_ctx.text.last ? last : nullptr;
+    }
+}
+
+void DaisyParserPass::trackIncludeGuard(InputContext& in_ctx, std::string_view directive_id,
+                                        const TextRange& directive_args) {
+    using GuardState = InputContext::IncludeGuardState;
+    switch (in_ctx.guard_state) {
+        case GuardState::kStart: {
+            // The first directive of the file must be `#ifndef <id>`
+            in_ctx.guard_state = GuardState::kNotGuarded;
+            if (directive_id != "ifndef") { break; }
+            TextRange args = directive_args;
+            skipWhitespaces(args);
+            const char* id_last = std::find_if(args.first, args.last,
+                                               [](char ch) { return !uxs::is_alnum(ch) && ch != '_'; });
+            if (id_last == args.first || uxs::is_digit(*args.first)) { break; }
+            // Note: guard section is not pushed yet, it is remembered after the directive is parsed
+            in_ctx.guard_state = GuardState::kInsideGuard;
+            in_ctx.guard_if_section = nullptr;
+            in_ctx.guard_macro = Identifier(std::string_view(args.first, id_last - args.first));
+        } break;
+        case GuardState::kInsideGuard: {
+            // Only directives of the guard section itself are of interest, not of nested ones
+            const auto* if_section = getIfSection();
+            if (if_section != in_ctx.guard_if_section || if_section->section_disable_counter > 1) { break; }
+            if (directive_id == "endif") {
+                in_ctx.guard_state = GuardState::kAfterGuard;
+            } else if (directive_id == "else" || directive_id.substr(0, 4) == "elif") {
+                in_ctx.guard_state = GuardState::kNotGuarded;
+            }
+        } break;
+        case GuardState::kAfterGuard: in_ctx.guard_state = GuardState::kNotGuarded; break;
+        default: break;
+    }
+}
+
 void daisy::logSyntaxError(int tt, const SymbolLoc& loc) {
     std::string_view msg;
     switch (tt) {
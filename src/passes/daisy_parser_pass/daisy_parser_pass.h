@@ -1,15 +1,23 @@
 #pragma once
 
 #include "ctx/ctx.h"
+#include "ctx/lexeme_cache.h"
 #include "ir/float_const.h"
 #include "ir/int_const.h"
 #include "ir/scope_descriptor.h"
 #include "ir/type_descriptor.h"
 #include "pass_manager.h"
+#include "util/spsc_queue.h"
 
 #include <uxs/string_cvt.h>
 
-#include <variant>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <exception>
+#include <new>
+#include <thread>
+#include <type_traits>
 
 #define DAISY_ADD_REDUCE_ACTION_HANDLER(act_id, fn) \
     static daisy::ReduceActionHandler g_act_handler_##act_id(parser_detail::act_id, fn)
@@ -26,14 +34,88 @@ namespace parser_detail {
 
 namespace daisy {
 
-using SymbolVal =
-    std::variant<bool, ir::IntConst, ir::FloatConst, std::string, std::string_view, std::unique_ptr<ir::Node>,
-                 ir::ScopeDescriptor, ir::TypeDescriptor, ir::DataTypeModifiers>;
+// Handle of a node kept in the node table of `DaisyParserPass`
+struct NodeRef {
+    std::uint32_t index;
+};
+
+// Adjacent string literals gathered in the string piece table of `DaisyParserPass`
+struct StringPieces {
+    std::uint32_t first;
+    std::uint32_t count;
+};
+
+// Semantic value of a token or a grammar symbol. It is trivially copyable, so symbols are shifted and reduced as plain
+// memory; values which own resources are kept in side tables of the parser and referred to by handles
+class SymbolVal {
+ public:
+    template<typename Ty>
+    bool is() const {
+        return kind_ == getKind<Ty>();
+    }
+
+    template<typename Ty>
+    Ty& get() {
+        assert(is<Ty>());
+        return *std::launder(reinterpret_cast<Ty*>(storage_));
+    }
+    template<typename Ty>
+    const Ty& get() const {
+        assert(is<Ty>());
+        return *std::launder(reinterpret_cast<const Ty*>(storage_));
+    }
+
+    template<typename Ty>
+    Ty* getIf() {
+        return is<Ty>() ? &get<Ty>() : nullptr;
+    }
+
+    template<typename Ty, typename... Args>
+    Ty& emplace(Args&&... args) {
+        static_assert(std::is_trivially_copyable_v<Ty> && sizeof(Ty) <= sizeof(storage_) &&
+                      alignof(Ty) <= alignof(std::uint64_t));
+        kind_ = getKind<Ty>();
+        return *::new (static_cast<void*>(storage_)) Ty(std::forward<Args>(args)...);
+    }
+
+    template<typename Ty>
+    SymbolVal& operator=(const Ty& v) {
+        emplace<Ty>(v);
+        return *this;
+    }
+
+ private:
+    template<typename... Ts>
+    struct TypeList {
+        template<typename Ty>
+        static constexpr std::uint8_t getKind() {
+            constexpr bool is_same[] = {std::is_same_v<Ty, Ts>...};
+            for (std::uint8_t kind = 0; kind < sizeof...(Ts); ++kind) {
+                if (is_same[kind]) { return kind + 1; }
+            }
+            return 0;
+        }
+    };
+
+    using Types = TypeList<bool, ir::IntConst, ir::FloatConst, std::string_view, StringPieces, Identifier, NodeRef,
+                           ir::ScopeDescriptor, ir::TypeDescriptor, ir::DataTypeModifiers>;
+
+    alignas(std::uint64_t) unsigned char storage_[16]{};
+    std::uint8_t kind_ = 0;  // 0 if empty
+
+    template<typename Ty>
+    static constexpr std::uint8_t getKind() {
+        constexpr std::uint8_t kind = Types::getKind<Ty>();
+        static_assert(kind != 0, "unsupported symbol value type");
+        return kind;
+    }
+};
 
 struct SymbolInfo {
     SymbolVal val;
     SymbolLoc loc;
 };
+static_assert(std::is_trivially_copyable_v<SymbolInfo>);
 
 struct MacroExpansion;
 
@@ -53,6 +135,9 @@ struct InputContext {
         kDisableMacroExpansion = 8,
         kSkipFile = 0x10,
     };
+    // Tracks whether the whole file is wrapped in `#ifndef <guard_macro>` ... `#endif`; only comments and
+    // whitespaces are allowed outside of the guard section
+    enum class IncludeGuardState : unsigned { kNotGuarded = 0, kStart, kInsideGuard, kAfterGuard };
     InputContext(TextRange txt, const LocationContext* ctx, Flags f = Flags::kNone)
         : text(txt), loc_ctx(ctx), flags(f) {}
     virtual ~InputContext() = default;
@@ -61,6 +146,15 @@ struct InputContext {
     Flags flags;
     MacroExpansion* macro_expansion = nullptr;
     const IfSectionState* last_if_section_state = nullptr;
+    const char* release_pos = nullptr;  // for streamed files: text before this position is already released
+    const char* unchecked_pos = nullptr;  // for files: text from this position is not searched for '\0' yet
+    const char* lexeme_base = nullptr;  // file text beginning if lexemes are replayed or recorded
+    const LexemeCache* lexeme_cache = nullptr;
+    std::size_t next_lexeme = 0;
+    std::unique_ptr<LexemeCache> recorded_lexemes;  // lexemes of the first pass through the file
+    IncludeGuardState guard_state = IncludeGuardState::kNotGuarded;
+    const IfSectionState* guard_if_section = nullptr;
+    Identifier guard_macro;
 };
 UXS_IMPLEMENT_BITWISE_OPS_FOR_ENUM(InputContext::Flags);
 
@@ -110,10 +204,20 @@ class DaisyParserPass : public Pass {
     void cleanup() override;
 
     CompilationContext& getCompilationContext() const { return *ctx_; }
+    // Prepares lexical analysis of the main file of `ctx`; `lex` can be called alone after it, e.g. by benchmarks
+    bool beginInput(CompilationContext& ctx);
     int lex(SymbolInfo& tkn, bool* leading_ws = nullptr);
     static int parse(int tt, int* sptr0, int** p_sptr, int rise_error);
     const InputFileInfo* pushInputFile(std::string_view file_path, const SymbolLoc& expansion_loc);
-    bool isKeyword(std::string_view id) const;
+    static bool isKeyword(std::string_view id);
+
+    // Side tables of symbol values: nodes are owned by the parser until they are taken to the tree, and adjacent
+    // string literals are gathered until the whole chain is parsed
+    ir::Node& setNode(SymbolVal& val, std::unique_ptr<ir::Node> node);
+    ir::Node& getNode(const SymbolVal& val) const { return *nodes_[val.get<NodeRef>().index]; }
+    std::unique_ptr<ir::Node> takeNode(SymbolVal& val);
+    void appendStringPiece(SymbolVal& val, std::string_view piece);
+    std::string_view takeString(const SymbolVal& val);
 
     IfSectionState* getIfSection() { return !if_section_stack_.empty() ? &if_section_stack_.front() : nullptr; }
     IfSectionState& pushIfSection(const SymbolLoc& loc) { return if_section_stack_.emplace_front(IfSectionState{loc}); }
@@ -141,7 +245,7 @@ class DaisyParserPass : public Pass {
                                            &newLocationContext(nullptr, macro_exp.loc, macro_exp.macro_def)));
     }
 
-    bool checkMacroExpansionForRecursion(std::string_view macro_id);
+    bool checkMacroExpansionForRecursion(Identifier macro_id);
     void ensureEndOfInput(SymbolInfo& tkn);
 
     const ir::RootNode& getRootScope() const {
@@ -168,6 +272,20 @@ class DaisyParserPass : public Pass {
     }
 
  private:
+    // Token lexed ahead of the parser; diagnostics reported while the token is lexed are held back and written when
+    // the parser takes the token, so the output keeps its order
+    struct BufferedToken {
+        int tt = 0;
+        SymbolInfo tkn;
+        std::string diag;
+        unsigned error_count = 0;  // errors and warnings reported while the token is lexed
+        unsigned warning_count = 0;
+    };
+
+    static constexpr std::size_t kTokenRingSize = 64;
+    static constexpr std::size_t kTokenQueueSize = 256;
+    using TokenQueue = util::spsc_queue<BufferedToken, kTokenQueueSize>;
+
     struct TextBuffer {
         explicit TextBuffer(std::size_t sz) : text(std::make_unique<char[]>(sz)), text_last(text.get() + sz) {}
         std::size_t getSize() const { return text_last - text.get(); }
@@ -180,6 +298,19 @@ class DaisyParserPass : public Pass {
     unsigned error_status_ = 0;
 
     SymbolInfo la_tkn_;
+    std::array<BufferedToken, kTokenRingSize> token_ring_;
+    std::size_t token_ring_first_ = 0;  // Note: indices grow monotonically and wrap around the ring size
+    std::size_t token_ring_last_ = 0;
+    bool is_end_of_file_taken_ = false;
+    // Note: in pipelined mode tokens are lexed by `producer_thread_` and passed through `token_queue_` instead
+    std::unique_ptr<TokenQueue> token_queue_;
+    std::thread producer_thread_;
+    std::atomic<bool> stop_producer_{false};
+    std::exception_ptr producer_error_;
+    std::vector<std::unique_ptr<ir::Node>> nodes_;
+    std::vector<std::uint32_t> free_node_slots_;
+    std::vector<std::string_view> string_pieces_;
+    std::string literal_buf_;
     std::forward_list<std::unique_ptr<InputContext>> input_ctx_stack_;
     uxs::inline_basic_dynbuffer<int, 1> lex_state_stack_;
     std::forward_list<IfSectionState> if_section_stack_;
@@ -187,9 +318,19 @@ class DaisyParserPass : public Pass {
     ir::Node* current_scope_;
 
     std::array<ReduceActionHandler::FuncType, parser_detail::total_action_count> reduce_action_handlers_;
+    // Note: the pass outlives compilations, so interned identifiers are not kept
     std::unordered_map<std::string_view, const PreprocDirectiveParser*> preproc_directive_parsers_;
 
+    void lexBufferedToken(BufferedToken& buffered);
+    int takeToken(SymbolInfo& tkn);
+    void fillTokenRing();
+    void discardTokens();
+    void startTokenProducer();
+    void stopTokenProducer();
+    void produceTokens(unsigned debug_level);
     void parsePreprocessorDirective();
+    void checkTextEnd(InputContext& in_ctx, const char* pos);
+    void trackIncludeGuard(InputContext& in_ctx, std::string_view directive_id, const TextRange& directive_args);
     void defineBuiltinMacros();
     void expandMacro(const SymbolLoc& loc, const MacroDefinition& macro_def);
     void expandMacroArgument(const TextRange& arg);
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "util/keyword_table.h"
+
+namespace daisy {
+
+// Keywords of the language and their token types, shared by `DaisyParserPass` and the benchmarks.
+// Note: token types are defined by `parser_defs.h`, which must be included into `parser_detail` namespace before
+inline constexpr auto kKeywords = std::to_array<util::keyword_entry>({
+    {"namespace", parser_detail::tt_namespace},
+    {"const", parser_detail::tt_const},
+    {"let", parser_detail::tt_let},
+    {"func", parser_detail::tt_func},
+    {"if", parser_detail::tt_if},
+    {"else", parser_detail::tt_else},
+    {"loop", parser_detail::tt_loop},
+    {"while", parser_detail::tt_while},
+    {"struct", parser_detail::tt_struct},
+    {"mut", parser_detail::tt_mut},
+});
+
+}  // namespace daisy
@@ -1,7 +1,7 @@
 /* Lexegen autogenerated analyzer file - do not edit! */
 /* clang-format off */
 
-static uint8_t symb2meta[256] = {
+static const uint8_t symb2meta[256] = {
     0, 1, 1, 1, 1, 1, 1, 1, 1, 2, 3, 1, 1, 2, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1, 2, 4, 5, 6, 1, 7, 8,
     1, 1, 1, 9, 10, 1, 11, 12, 13, 14, 15, 16, 17, 18, 19, 20, 19, 21, 22, 23, 1, 24, 25, 26, 1, 1, 27, 27, 27, 27, 28,
     27, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 29, 1, 30, 1, 31, 32, 1, 33, 34, 27,
@@ -12,7 +12,7 @@ static uint8_t symb2meta[256] = {
     1, 1, 1, 1, 1, 1, 1, 1
 };
 
-static int def[122] = {
+static const int8_t def[122] = {
     -1, 0, -1, 2, 2, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
     -1, -1, -1, -1, -1, -1, -1, 36, -1, -1, -1, -1, -1, -1, -1, 42, 42, -1, -1, -1, 42, 42, 42, 42, 42, 42, 42, -1, -1,
     -1, -1, -1, -1, -1, -1, -1, -1, -1, 34, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 70, 69, 81, 36, 68, -1, -1, -1,
@@ -20,7 +20,7 @@ static int def[122] = {
     -1, -1, -1, -1, -1
 };
 
-static int base[122] = {
+static const uint16_t base[122] = {
     0, 45, 51, 0, 95, 0, 0, 125, 0, 0, 87, 0, 0, 0, 0, 0, 0, 0, 158, 181, 0, 94, 0, 0, 113, 0, 23, 0, 0, 24, 91, 25, 92,
     95, 206, 220, 220, 252, 95, 98, 99, 156, 284, 329, 158, 151, 147, 164, 0, 0, 145, 155, 0, 166, 164, 171, 0, 0, 0, 0,
     0, 182, 0, 0, 186, 0, 0, 0, 247, 366, 375, 226, 270, 192, 197, 201, 0, 214, 213, 0, 366, 239, 208, 213, 396, 405,
@@ -28,7 +28,7 @@ static int base[122] = {
     0, 0, 0, 0, 0, 0, 286, 286, 0
 };
 
-static int next[489] = {
+static const int8_t next[489] = {
     -1, 23, 119, 25, 26, 27, 120, 29, 30, 31, 32, 33, 34, 35, 36, 37, 37, 37, 37, 37, 37, 37, 37, 38, 39, 40, 41, 42,
     42, 42, 43, 44, 42, 42, 42, 42, 45, 42, 42, 42, 42, 42, 46, 42, 42, 42, 47, 24, 118, 117, 114, 28, 4, 4, 5, 4, 6, 4,
     4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 7, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4, 4,
@@ -48,7 +48,7 @@ static int next[489] = {
     -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
 };
 
-static int check[489] = {
+static const uint8_t check[489] = {
     0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
     0, 0, 0, 0, 0, 0, 0, 0, 1, 26, 29, 31, 1, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
     2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 4, 30, 4, 10, 10, 10, 10, 10, 10, 10, 21, 21, 21, 21,
@@ -67,7 +67,7 @@ static int check[489] = {
     90, 90, 90, 90, 105, 90, 90, 90, 90, 90, 90, 90, 90, 90, 90, 100, 100, 100, 100, 100, 100, 100
 };
 
-static int accept[122] = {
+static const uint8_t accept[122] = {
     0, 0, 0, 0, 11, 13, 12, 53, 10, 14, 1, 3, 4, 5, 7, 6, 8, 9, 10, 2, 2, 1, 1, 53, 44, 45, 53, 52, 50, 53, 53, 53, 53,
     53, 53, 53, 37, 38, 53, 53, 53, 53, 41, 53, 53, 41, 41, 53, 29, 22, 41, 41, 34, 41, 41, 41, 35, 30, 47, 46, 20, 16,
     32, 17, 15, 19, 31, 48, 40, 0, 0, 40, 38, 0, 0, 0, 38, 0, 0, 40, 38, 0, 40, 37, 40, 0, 0, 37, 0, 39, 39, 0, 0, 0,
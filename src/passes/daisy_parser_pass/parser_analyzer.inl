@@ -1,7 +1,7 @@
 /* Parsegen autogenerated analyzer file - do not edit! */
 /* clang-format off */
 
-static int action_idx[258] = {
+static const uint16_t action_idx[258] = {
     0, 2, 20, 2, 2, 2, 2, 2, 62, 64, 66, 68, 72, 76, 80, 82, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
     84, 120, 154, 170, 186, 210, 234, 246, 258, 290, 320, 2, 362, 402, 418, 434, 436, 444, 452, 454, 482, 484, 486, 488,
     530, 532, 534, 536, 552, 554, 558, 560, 564, 566, 570, 574, 578, 582, 586, 588, 590, 608, 612, 616, 618, 622, 624,
@@ -16,7 +16,7 @@ static int action_idx[258] = {
     1858, 1862, 1864, 1866, 1882, 1884, 1886
 };
 
-static int action_list[1888] = {
+static const int16_t action_list[1888] = {
     -1, 12, 33, 7, 40, 9, 43, 11, 45, 13, 126, 15, 261, 17, 262, 19, 265, 21, -1, -1, 37, 33, 38, 35, 42, 37, 43, 39,
     45, 41, 47, 43, 60, 45, 62, 47, 63, 49, 94, 51, 124, 53, 260, 123, 269, 55, 270, 57, 271, 59, 272, 61, 273, 63, 274,
     65, 275, 67, 276, 69, -1, -1, -1, 846, -1, 852, -1, 834, 40, 25, -1, -1, 265, 27, -1, -1, 41, 29, -1, -1, -1, 840,
@@ -93,7 +93,7 @@ static int action_list[1888] = {
     -1, 12, 59, 131, 125, 511, 258, 133, 288, 137, 289, 139, 291, 141, 296, 143, -1, -1, -1, 24, -1, 60, -1, 54
 };
 
-static int reduce_info[429] = {
+static const uint8_t reduce_info[429] = {
     2, 0, 0, 2, 2, 0, 0, 2, 0, 0, 8, 1, 6, 6, 2, 3, 6, 0, 3, 6, 54, 0, 36, 55, 4, 6, 54, 2, 6, 0, 2, 6, 0, 1, 6, 0, 1,
     10, 0, 3, 10, 0, 4, 44, 41, 1, 116, 0, 3, 116, 0, 5, 118, 42, 0, 48, 59, 2, 48, 43, 0, 144, 52, 6, 16, 53, 0, 142,
     59, 3, 142, 57, 2, 142, 58, 0, 140, 0, 1, 140, 0, 1, 146, 0, 3, 146, 0, 4, 148, 56, 2, 132, 60, 0, 122, 61, 1, 122,
@@ -110,7 +110,7 @@ static int reduce_info[429] = {
     86, 3, 202, 87, 3, 202, 88, 5, 202, 89, 3, 202, 90, 0, 254, 91, 5, 202, 92, 1, 202, 0, 1, 202, 0
 };
 
-static int goto_list[256] = {
+static const int16_t goto_list[256] = {
     -1, 0, 253, 254, -1, 62, -1, 63, -1, 253, 69, 249, 83, 236, -1, 215, 70, 245, -1, 86, 86, 108, 138, 196, 141, 143,
     144, 145, 197, 198, 199, 200, 245, 246, -1, 113, -1, 248, 75, 76, 112, 114, -1, 64, 221, 223, -1, 216, 217, 218, -1,
     207, 112, 115, 124, 230, 125, 228, 126, 227, 127, 226, 129, 225, 146, 195, 147, 194, 149, 186, 150, 185, 151, 184,
@@ -127,14 +127,14 @@ static int parse(int tt, int* sptr0, int** p_sptr, int rise_error) {
     enum { shift_flag = 1, flag_count = 1 };
     int action = rise_error;
     if (action >= 0) {
-        const int* action_tbl = &action_list[action_idx[*(*p_sptr - 1)]];
+        const int16_t* action_tbl = &action_list[action_idx[*(*p_sptr - 1)]];
         while (action_tbl[0] >= 0 && action_tbl[0] != tt) { action_tbl += 2; }
         action = action_tbl[1];
     }
     if (action >= 0) {
         if (!(action & shift_flag)) {
-            const int* info = &reduce_info[action >> flag_count];
-            const int* goto_tbl = &goto_list[info[1]];
+            const uint8_t* info = &reduce_info[action >> flag_count];
+            const int16_t* goto_tbl = &goto_list[info[1]];
             int state = *((*p_sptr -= info[0]) - 1);
             while (goto_tbl[0] >= 0 && goto_tbl[0] != state) { goto_tbl += 2; }
             *(*p_sptr)++ = goto_tbl[1];
@@ -145,7 +145,7 @@ static int parse(int tt, int* sptr0, int** p_sptr, int rise_error) {
     }
     /* Roll back to state, which can accept error */
     do {
-        const int* action_tbl = &action_list[action_idx[*(*p_sptr - 1)]];
+        const int16_t* action_tbl = &action_list[action_idx[*(*p_sptr - 1)]];
         while (action_tbl[0] >= 0 && action_tbl[0] != predef_tt_error) { action_tbl += 2; }
         if (action_tbl[1] >= 0 && (action_tbl[1] & shift_flag)) { /* Can recover */
             *(*p_sptr)++ = action_tbl[1] >> flag_count;           /* Shift error token */
@@ -2,6 +2,8 @@
 #include "../text_utils.h"
 #include "logger.h"
 
+#include <utility>
+
 using namespace daisy;
 
 constexpr std::string_view kVaArgsId = "__va_args__";
@@ -15,9 +17,9 @@ void parseDefineDirective(DaisyParserPass* pass, SymbolInfo& tkn) {
         return;
     }
 
-    const auto id = std::get<std::string_view>(tkn.val);
-    if (pass->isKeyword(id)) {
-        logger::error(tkn.loc).println("keyword `{}` cannot be used as macro identifier", id);
+    const auto id = tkn.val.get<Identifier>();
+    if (pass->isKeyword(id.getText())) {
+        logger::error(tkn.loc).println("keyword `{}` cannot be used as macro identifier", id.getText());
         return;
     }
 
@@ -29,18 +31,20 @@ void parseDefineDirective(DaisyParserPass* pass, SymbolInfo& tkn) {
         unsigned count = 0;
         ++in_ctx.text.first, ++in_ctx.text.pos.col;
         while (true) {
-            std::string_view arg_id;
+            Identifier arg_id;
             if (tt = pass->lex(tkn); tt == parser_detail::tt_id) {
-                arg_id = std::get<std::string_view>(tkn.val);
-                if (pass->isKeyword(arg_id)) {  // is a keyword
-                    logger::error(tkn.loc).println("keyword `{}` cannot be used as macro argument identifier", arg_id);
+                arg_id = tkn.val.get<Identifier>();
+                if (pass->isKeyword(arg_id.getText())) {  // is a keyword
+                    logger::error(tkn.loc).println("keyword `{}` cannot be used as macro argument identifier",
+                                                   arg_id.getText());
                     return;
-                } else if (arg_id == kVaArgsId) {  // variadic argument identifier
-                    logger::error(tkn.loc).println("identifier `{}` is reserved for variadic argument", arg_id);
+                } else if (arg_id.getText() == kVaArgsId) {  // variadic argument identifier
+                    logger::error(tkn.loc).println("identifier `{}` is reserved for variadic argument",
+                                                   arg_id.getText());
                     return;
                 }
             } else if (tt == parser_detail::tt_ellipsis) {
-                arg_id = kVaArgsId, macro_def->is_variadic = true;
+                arg_id = Identifier(kVaArgsId), macro_def->is_variadic = true;
             } else {
                 logger::error(tkn.loc).println("expected macro argument identifier or `...`");
                 return;
@@ -73,11 +77,11 @@ void parseDefineDirective(DaisyParserPass* pass, SymbolInfo& tkn) {
     auto& ctx = pass->getCompilationContext();
     if (auto [it, success] = ctx.macro_defs.try_emplace(id, std::move(macro_def)); !success) {
         if (it->second->type != MacroDefinition::Type::kUserDefined) {
-            logger::warning(tkn.loc).println("builtin macro `{}` redefinition", id);
+            logger::warning(tkn.loc).println("builtin macro `{}` redefinition", id.getText());
         } else {
-            logger::warning(tkn.loc).println("macro `{}` redefinition", id);
+            logger::warning(tkn.loc).println("macro `{}` redefinition", id.getText());
         }
-        it->second = std::move(macro_def);
+        ctx.retired_macro_defs.push_back(std::exchange(it->second, std::move(macro_def)));
     }
 }
 
@@ -88,15 +92,16 @@ void parseUndefDirective(DaisyParserPass* pass, SymbolInfo& tkn) {
         return;
     }
     auto& ctx = pass->getCompilationContext();
-    const auto id = std::get<std::string_view>(tkn.val);
+    const auto id = tkn.val.get<Identifier>();
     auto it = ctx.macro_defs.find(id);
     if (it != ctx.macro_defs.end()) {
         if (it->second->type != MacroDefinition::Type::kUserDefined) {
-            logger::warning(tkn.loc).println("cannot undefine builtin macro `{}`", id);
+            logger::warning(tkn.loc).println("cannot undefine builtin macro `{}`", id.getText());
         }
-        ctx.macro_defs.erase(id);
+        ctx.retired_macro_defs.push_back(std::move(it->second));
+        ctx.macro_defs.erase(it);
     } else {
-        logger::warning(tkn.loc).println("macro `{}` is not defined", id);
+        logger::warning(tkn.loc).println("macro `{}` is not defined", id.getText());
     }
     pass->ensureEndOfInput(tkn);
 }
@@ -157,7 +162,7 @@ std::string stringizeMacro(DaisyParserPass* pass, const MacroExpansion& macro_ex
             if (!remove_ws && leading_ws) { text.push_back(' '); }
             remove_ws = false;
             if (tt == parser_detail::tt_string_literal) {
-                uxs::basic_format(text, "{:?}", std::get<std::string>(tkn.val));
+                uxs::basic_format(text, "{:?}", tkn.val.get<std::string_view>());
             } else {
                 const auto& curr_ctx = pass->getInputContext();
                 assert(tkn.loc.first.ln == tkn.loc.last.ln && tkn.loc.first.col <= tkn.loc.last.col);
@@ -196,7 +201,7 @@ const std::vector<std::tuple<std::string_view, bool, BuiltInMacroImpl>> g_builti
 DAISY_ADD_PREPROC_DIRECTIVE_PARSER(define, parseDefineDirective);
 DAISY_ADD_PREPROC_DIRECTIVE_PARSER(undef, parseUndefDirective);
 
-bool DaisyParserPass::checkMacroExpansionForRecursion(std::string_view macro_id) {
+bool DaisyParserPass::checkMacroExpansionForRecursion(Identifier macro_id) {
     const auto& in_ctx = getInputContext();
     for (const auto* loc_ctx = in_ctx.loc_ctx; loc_ctx->expansion.loc.loc_ctx;
          loc_ctx = loc_ctx->expansion.loc.loc_ctx) {
@@ -211,14 +216,15 @@ bool DaisyParserPass::checkMacroExpansionForRecursion(std::string_view macro_id)
 
 void DaisyParserPass::defineBuiltinMacros() {
     for (unsigned n = 0; n < g_builtin_macro_impl.size(); ++n) {
-        const auto& [id, is_variadic, impl_func] = g_builtin_macro_impl[n];
+        const auto& [id_text, is_variadic, impl_func] = g_builtin_macro_impl[n];
+        const Identifier id(id_text);
         ctx_->macro_defs[id] = std::make_unique<MacroDefinition>(MacroDefinition::Type::kBuiltIn + n, id, is_variadic);
     }
 }
 
 void DaisyParserPass::expandMacro(const SymbolLoc& loc, const MacroDefinition& macro_def) {
     auto& in_ctx = getInputContext();
-    const std::string_view id = macro_def.id;
+    const std::string_view id = macro_def.id.getText();
 
     auto& loc_ctx = newLocationContext(macro_def.loc.loc_ctx ? macro_def.loc.loc_ctx->file : nullptr, loc, &macro_def);
     auto macro_exp_ctx = std::make_unique<MacroExpansionContext>(macro_def.text, &loc_ctx, &macro_def, &in_ctx, loc);
@@ -296,7 +302,7 @@ void DaisyParserPass::expandMacro(const SymbolLoc& loc, const MacroDefinition& m
         return;
     }
 
-    if (checkMacroExpansionForRecursion(id)) {
+    if (checkMacroExpansionForRecursion(macro_def.id)) {
         logger::error(loc).println("recursive macro `{}` expansion", id);
         return;
     }
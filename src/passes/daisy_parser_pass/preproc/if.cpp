@@ -15,25 +15,25 @@ bool evalCondition(DaisyParserPass* pass, SymbolInfo& tkn) {
     auto& in_ctx = pass->getInputContext();
     in_ctx.flags &= ~InputContext::Flags::kDisableMacroExpansion;
 
-    auto cast_to_bool = [](const auto& tkn) {
-        if (std::holds_alternative<bool>(tkn.val)) { return std::get<bool>(tkn.val); }
-        return !std::get<ir::IntConst>(tkn.val).isZero();
+    auto cast_to_bool = [](const SymbolInfo& tkn) {
+        if (tkn.val.is<bool>()) { return tkn.val.get<bool>(); }
+        return !tkn.val.get<ir::IntConst>().isZero();
     };
 
-    auto check_integer_type = [](const auto& tkn) {
-        if (std::holds_alternative<ir::IntConst>(tkn.val)) { return true; }
+    auto check_integer_type = [](const SymbolInfo& tkn) {
+        if (tkn.val.is<ir::IntConst>()) { return true; }
         logger::error(tkn.loc).println("expected integer expression");
         return false;
     };
 
-    auto check_non_zero = [](const auto& tkn) {
-        if (!std::get<ir::IntConst>(tkn.val).isZero()) { return true; }
+    auto check_non_zero = [](const SymbolInfo& tkn) {
+        if (!tkn.val.get<ir::IntConst>().isZero()) { return true; }
         logger::error(tkn.loc).println("integer division by zero");
         return false;
     };
 
-    auto check_sign_mismatch = [](const auto* ss) {
-        if (std::get<ir::IntConst>(ss[0].val).isSigned() != std::get<ir::IntConst>(ss[2].val).isSigned()) {
+    auto check_sign_mismatch = [](const SymbolInfo* ss) {
+        if (ss[0].val.get<ir::IntConst>().isSigned() != ss[2].val.get<ir::IntConst>().isSigned()) {
             logger::warning(ss[1].loc).println("signed/unsigned mismatch");
         }
     };
@@ -56,7 +56,7 @@ bool evalCondition(DaisyParserPass* pass, SymbolInfo& tkn) {
             if (act == parser_detail::act_preproc_op_u_minus || act == parser_detail::act_preproc_op_u_plus ||
                 act == parser_detail::act_preproc_op_bitwise_not) {
                 if (!check_integer_type(ss[1])) { return true; }
-                const auto& operand = std::get<ir::IntConst>(ss[1].val);
+                const auto& operand = ss[1].val.get<ir::IntConst>();
                 switch (act) {
                     case parser_detail::act_preproc_op_u_minus: ss[0].val = -operand; break;
                     case parser_detail::act_preproc_op_u_plus: ss[0].val = operand; break;
@@ -65,8 +65,8 @@ bool evalCondition(DaisyParserPass* pass, SymbolInfo& tkn) {
                 }
             } else if (act >= parser_detail::act_preproc_op_add && act <= parser_detail::act_preproc_op_gt) {
                 if (!check_integer_type(ss[0]) || !check_integer_type(ss[2])) { return true; }
-                const auto& operand1 = std::get<ir::IntConst>(ss[0].val);
-                const auto& operand2 = std::get<ir::IntConst>(ss[2].val);
+                const auto& operand1 = ss[0].val.get<ir::IntConst>();
+                const auto& operand2 = ss[2].val.get<ir::IntConst>();
                 switch (act) {
                     case parser_detail::act_preproc_op_add: ss[0].val = operand1 + operand2; break;
                     case parser_detail::act_preproc_op_sub: ss[0].val = operand1 - operand2; break;
@@ -115,17 +115,17 @@ bool evalCondition(DaisyParserPass* pass, SymbolInfo& tkn) {
                     } break;
                     case parser_detail::act_preproc_brackets: ss[0].val = std::move(ss[1].val); break;
                     case parser_detail::act_preproc_op_conditional: {
-                        ss[0].val = cast_to_bool(ss[0]) ? std::get<ir::IntConst>(ss[2].val) :
-                                                          std::get<ir::IntConst>(ss[4].val);
+                        ss[0].val = cast_to_bool(ss[0]) ? ss[2].val.get<ir::IntConst>() :
+                                                          ss[4].val.get<ir::IntConst>();
                     } break;
                     case parser_detail::act_preproc_operator_begin: {
                         in_ctx.flags |= InputContext::Flags::kDisableMacroExpansion;
                     } break;
                     case parser_detail::act_preproc_operator_end: {
                         in_ctx.flags &= ~InputContext::Flags::kDisableMacroExpansion;
-                        const auto id = std::get<std::string_view>(ss[0].val);
-                        if (id == "defined") {
-                            const auto macro_id = std::get<std::string_view>(ss[3].val);
+                        const auto id = ss[0].val.get<Identifier>();
+                        if (id.getText() == "defined") {
+                            const auto macro_id = ss[3].val.get<Identifier>();
                             const auto& ctx = pass->getCompilationContext();
                             ss[0].val = ctx.macro_defs.find(macro_id) != ctx.macro_defs.end();
                         } else {
@@ -157,7 +157,7 @@ bool evalIsDefined(DaisyParserPass* pass, SymbolInfo& tkn) {
         return true;
     }
 
-    const auto macro_id = std::get<std::string_view>(tkn.val);
+    const auto macro_id = tkn.val.get<Identifier>();
     const auto& ctx = pass->getCompilationContext();
     bool result = ctx.macro_defs.find(macro_id) != ctx.macro_defs.end();
     pass->ensureEndOfInput(tkn);
@@ -1,4 +1,5 @@
 #include "../daisy_parser_pass.h"
+#include "ctx/include_cache.h"
 #include "logger.h"
 
 #include <filesystem>
@@ -14,8 +15,9 @@ void parseIncludeDirective(DaisyParserPass* pass, SymbolInfo& tkn) {
         return;
     }
 
-    auto file_name = std::move(std::get<std::string>(tkn.val));
-    const auto& include_paths = pass->getCompilationContext().include_paths;
+    const auto file_name = tkn.val.get<std::string_view>();
+    auto& ctx = pass->getCompilationContext();
+    const auto& include_paths = ctx.include_paths;
 
     std::filesystem::path path(tkn.loc.loc_ctx->file->file_name);
     auto include_path_it = include_paths.begin();
@@ -24,13 +26,39 @@ void parseIncludeDirective(DaisyParserPass* pass, SymbolInfo& tkn) {
     pass->ensureEndOfInput(tkn);
     path = path.has_parent_path() ? path.parent_path() : "./";
 
+    // Note: paths probed before the resolved one are tracked as missing files, because a file appearing there later
+    // would change the result
+    auto& include_cache = IncludeCache::getInstance();
+    std::string cache_key = IncludeCache::makeKey(ctx.working_dir, path.generic_string(), include_paths, file_name);
+    if (auto entry = include_cache.find(cache_key)) {
+        ctx.missing_files.insert(ctx.missing_files.end(), entry->missing_paths.begin(), entry->missing_paths.end());
+        if (entry->resolved_path.empty()) {
+            logger::error(expansion_loc).println("could not open input file `{}`", file_name);
+            return;
+        }
+        if (pass->pushInputFile(entry->resolved_path, expansion_loc)) { return; }
+        // The file has gone since it was resolved, so search it again
+    }
+
+    const std::size_t missing_count = ctx.missing_files.size();
+    auto add_cache_entry = [&](std::string resolved_path) {
+        include_cache.add(std::move(cache_key),
+                          IncludeCache::Entry{std::move(resolved_path),
+                                              {ctx.missing_files.begin() + missing_count, ctx.missing_files.end()}});
+    };
+
     while (true) {
         path /= file_name;
-        if (pass->pushInputFile(path.generic_string(), expansion_loc)) { return; }
+        std::string probe_path = path.generic_string();
+        if (pass->pushInputFile(probe_path, expansion_loc)) {
+            add_cache_entry(std::move(probe_path));
+            return;
+        }
         if (include_path_it == include_paths.end()) { break; }
         path = *include_path_it++;
     }
 
+    add_cache_entry(std::string());
     logger::error(expansion_loc).println("could not open input file `{}`", file_name);
 }
 
@@ -8,10 +8,11 @@ namespace {
 void pragmaOnce(DaisyParserPass* pass, SymbolInfo& /*tkn*/) {
     auto& in_ctx = pass->getInputContext();
     assert(in_ctx.loc_ctx->file);
-    if (!!(in_ctx.loc_ctx->file->flags & InputFileInfo::Flags::kOnce)) {
-        in_ctx.flags |= InputContext::Flags::kSkipFile;
-    }
-    in_ctx.loc_ctx->file->flags |= InputFileInfo::Flags::kOnce;
+    // Note: further inclusions are skipped by `pushInputFile`, so the file is entered again only if it is included
+    // recursively before the pragma
+    const auto& origin = in_ctx.loc_ctx->file->getOrigin();
+    if (!!(origin.flags & InputFileInfo::Flags::kOnce)) { in_ctx.flags |= InputContext::Flags::kSkipFile; }
+    origin.flags |= InputFileInfo::Flags::kOnce;
 }
 
 using PragmaImpl = void (*)(DaisyParserPass*, SymbolInfo& tkn);
@@ -29,7 +30,7 @@ void parsePragmaDirective(DaisyParserPass* pass, SymbolInfo& tkn) {
         return;
     }
 
-    auto it = g_pragma_impl.find(std::get<std::string_view>(tkn.val));
+    auto it = g_pragma_impl.find(tkn.val.get<Identifier>().getText());
     if (it != g_pragma_impl.end()) {
         it->second(pass, tkn);
     } else {
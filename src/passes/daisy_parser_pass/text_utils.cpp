@@ -1,15 +1,130 @@
 #include "text_utils.h"
 
 #include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+
+#if defined(__SSE2__)
+#    include <emmintrin.h>
+#    define DAISY_HAS_SSE2 1
+#    if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#        include <immintrin.h>
+#        define DAISY_HAS_AVX2 1  // compiled for the function target and selected at run time
+#    endif
+#endif
 
 using namespace daisy;
 
+namespace {
+
+// Delimiter sets of scanning functions; runs of other characters are skipped 16 or 32 bytes at a time
+// Note: '\n' is always a delimiter, so text position is updated as before
+constexpr char kNewLine[] = {'\n'};
+constexpr char kCommentDelims[] = {'\n', '/'};
+constexpr char kStringDelims[] = {'\n', '\\', '\"'};
+constexpr char kBlanks[] = {' ', '\t', '\r'};
+constexpr char kMacroArgDelims[] = {'\n', '\\', '\"', '/', '(', ')', ','};
+constexpr char kDirectiveDelims[] = {'\n', '\\', '\"', '/', '#'};
+
+template<std::size_t N>
+bool isOneOf(char ch, const char (&set)[N]) {
+    return std::find(std::begin(set), std::end(set), ch) != std::end(set);
+}
+
+// Returns the first character which is (or is not if `kNegate` is `true`) one of `set`
+template<bool kNegate, std::size_t N>
+const char* scanScalar(const char* p, const char* last, const char (&set)[N]) {
+    while (p != last && isOneOf(*p, set) == kNegate) { ++p; }
+    return p;
+}
+
+#if defined(DAISY_HAS_SSE2)
+template<bool kNegate, std::size_t N>
+const char* scanSse2(const char* p, const char* last, const char (&set)[N]) {
+    __m128i v_set[N];
+    for (std::size_t i = 0; i < N; ++i) { v_set[i] = _mm_set1_epi8(set[i]); }
+    for (; last - p >= 16; p += 16) {
+        const __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+        __m128i eq = _mm_cmpeq_epi8(v, v_set[0]);
+        for (std::size_t i = 1; i < N; ++i) { eq = _mm_or_si128(eq, _mm_cmpeq_epi8(v, v_set[i])); }
+        unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(eq));
+        if constexpr (kNegate) { mask ^= 0xffff; }
+        if (mask) { return p + std::countr_zero(mask); }
+    }
+    return scanScalar<kNegate>(p, last, set);
+}
+#endif  // defined(DAISY_HAS_SSE2)
+
+#if defined(DAISY_HAS_AVX2)
+template<bool kNegate, std::size_t N>
+__attribute__((target("avx2"))) const char* scanAvx2(const char* p, const char* last, const char (&set)[N]) {
+    __m256i v_set[N];
+    for (std::size_t i = 0; i < N; ++i) { v_set[i] = _mm256_set1_epi8(set[i]); }
+    for (; last - p >= 32; p += 32) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+        __m256i eq = _mm256_cmpeq_epi8(v, v_set[0]);
+        for (std::size_t i = 1; i < N; ++i) { eq = _mm256_or_si256(eq, _mm256_cmpeq_epi8(v, v_set[i])); }
+        unsigned mask = static_cast<unsigned>(_mm256_movemask_epi8(eq));
+        if constexpr (kNegate) { mask = ~mask; }
+        if (mask) { return p + std::countr_zero(mask); }
+    }
+    return scanSse2<kNegate>(p, last, set);
+}
+#endif  // defined(DAISY_HAS_AVX2)
+
+TextScanKernel getBestTextScanKernel() {
+#if defined(DAISY_HAS_AVX2)
+    if (__builtin_cpu_supports("avx2")) { return TextScanKernel::kAvx2; }
+#endif
+#if defined(DAISY_HAS_SSE2)
+    return TextScanKernel::kSse2;
+#else
+    return TextScanKernel::kScalar;
+#endif
+}
+
+TextScanKernel g_text_scan_kernel = getBestTextScanKernel();
+
+template<bool kNegate, std::size_t N>
+const char* scan(const char* p, const char* last, const char (&set)[N]) {
+    switch (g_text_scan_kernel) {
+#if defined(DAISY_HAS_AVX2)
+        case TextScanKernel::kAvx2: return scanAvx2<kNegate>(p, last, set);
+#endif
+#if defined(DAISY_HAS_SSE2)
+        case TextScanKernel::kSse2: return scanSse2<kNegate>(p, last, set);
+#endif
+        default: return scanScalar<kNegate>(p, last, set);
+    }
+}
+
+template<std::size_t N>
+const char* findFirstOf(const char* p, const char* last, const char (&set)[N]) {
+    return scan<false>(p, last, set);
+}
+
+template<std::size_t N>
+const char* findFirstNotOf(const char* p, const char* last, const char (&set)[N]) {
+    return scan<true>(p, last, set);
+}
+
+}  // namespace
+
+TextScanKernel daisy::getTextScanKernel() { return g_text_scan_kernel; }
+
+bool daisy::setTextScanKernel(TextScanKernel kernel) {
+    if (kernel > getBestTextScanKernel()) { return false; }
+    g_text_scan_kernel = kernel;
+    return true;
+}
+
 void daisy::skipTillNewLine(TextRange& text) {
-    const char* eol = std::find(text.first, text.last, '\n');
+    const char* eol = findFirstOf(text.first, text.last, kNewLine);
     if (eol != text.first) {
         text.pos.col += static_cast<unsigned>(eol - text.first);
         while (eol != text.last && *(eol - 1) == '\\') {
-            const char* next_eol = std::find(eol + 1, text.last, '\n');
+            const char* next_eol = findFirstOf(eol + 1, text.last, kNewLine);
             ++text.pos.ln, text.pos.col = static_cast<unsigned>(next_eol - eol);
             eol = next_eol;
         }
@@ -22,10 +137,10 @@ bool daisy::skipCommentBlock(TextRange& text) {
     bool is_terminated = false;
     if (p != text.last) {
         if (*p == '/') { ++p; }
-        while (p != text.last) {
-            if (char ch = *p++; ch == '\n') {
+        while ((p = findFirstOf(p, text.last, kCommentDelims)) != text.last) {
+            if (*p++ == '\n') {
                 text.pos.nextLn(), p0 = p;
-            } else if (ch == '/' && *(p - 2) == '*') {
+            } else if (*(p - 2) == '*') {
                 is_terminated = true;
                 break;
             }
@@ -37,7 +152,7 @@ bool daisy::skipCommentBlock(TextRange& text) {
 
 void daisy::skipString(TextRange& text) {
     const char *p = text.first, *p0 = p;
-    while (p != text.last) {
+    while ((p = findFirstOf(p, text.last, kStringDelims)) != text.last) {
         switch (*p++) {
             case '\\': {  // Skip any character after '\\', count newlines
                 if (p != text.last && *p++ == '\n') { text.pos.nextLn(), p0 = p; }
@@ -52,12 +167,9 @@ stop:
 
 void daisy::skipWhitespaces(TextRange& text) {
     const char *p = text.first, *p0 = p;
-    while (p != text.last) {
+    while ((p = findFirstNotOf(p, text.last, kBlanks)) != text.last) {  // Skip whitespaces
         switch (*p) {
-            case '\r':
-            case '\t':
-            case ' ': ++p; break;  // Skip whitespace
-            case '\\': {           // Treat '\\\n' sequence as whitespace, stop on '\\' otherwise
+            case '\\': {  // Treat '\\\n' sequence as whitespace, stop on '\\' otherwise
                 if (p + 1 == text.last || *(p + 1) != '\n') { goto stop; }
                 text.pos.nextLn(), p0 = p += 2;
             } break;
@@ -87,12 +199,9 @@ const char* daisy::trimTrailingWhitespaces(const char* first, const char* last)
 
 void daisy::findMacroArgumentList(TextRange& text) {
     const char *p = text.first, *p0 = p;
-    while (p != text.last) {
+    while ((p = findFirstNotOf(p, text.last, kBlanks)) != text.last) {  // Skip whitespaces
         switch (*p) {
-            case '\r':
-            case '\t':
-            case ' ': ++p; break;  // Skip whitespace
-            case '\\': {           // Treat '\\\n' sequence as whitespace, stop on '\\' otherwise
+            case '\\': {  // Treat '\\\n' sequence as whitespace, stop on '\\' otherwise
                 if (p + 1 == text.last || *(p + 1) != '\n') { goto stop; }
                 text.pos.nextLn(), p0 = p += 2;
             } break;
@@ -118,7 +227,7 @@ stop:
 void daisy::findMacroArgumentSeparator(TextRange& text) {
     const char *p = text.first, *p0 = p;
     unsigned bracket_level = 0;
-    while (p != text.last) {
+    while ((p = findFirstOf(p, text.last, kMacroArgDelims)) != text.last) {
         switch (*p) {
             case '(': ++bracket_level, ++p; break;
             case ')': {  // Stop on closing balanced ')'
@@ -149,7 +258,6 @@ void daisy::findMacroArgumentSeparator(TextRange& text) {
                 p = p0 = text.first;
             } break;
             case '\n': text.pos.nextLn(), p0 = ++p; break;  // Skip newlines
-            default: ++p; break;                            // Skip all other characters
         }
     }
 stop:
@@ -158,7 +266,7 @@ stop:
 
 void daisy::skipTillPreprocDirective(TextRange& text) {
     const char *p = text.first, *p0 = p;
-    while (p != text.last) {
+    while ((p = findFirstOf(p, text.last, kDirectiveDelims)) != text.last) {
         switch (*p++) {
             case '#': {  // Stop after '#' character at beginning of a line
                 if ((p0 < text.first + 2 || *(p0 - 2) != '\\') &&
@@ -186,7 +294,6 @@ void daisy::skipTillPreprocDirective(TextRange& text) {
                 p = p0 = text.first;
             } break;
             case '\n': text.pos.nextLn(), p0 = p; break;  // Skip newlines
-            default: break;                               // Skip all other characters
         }
     }
 stop:
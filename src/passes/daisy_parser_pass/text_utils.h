@@ -4,6 +4,12 @@
 
 namespace daisy {
 
+// Implementation of character scanning loops; the best one supported by the CPU is selected at startup
+enum class TextScanKernel { kScalar = 0, kSse2, kAvx2 };
+
+TextScanKernel getTextScanKernel();
+bool setTextScanKernel(TextScanKernel kernel);  // returns `false` if the kernel is not supported
+
 void skipTillNewLine(TextRange& text);
 bool skipCommentBlock(TextRange& text);
 void skipString(TextRange& text);
@@ -0,0 +1,112 @@
+#include "ctx/ctx.h"
+#include "ir/nodes/func_def_node.h"
+#include "logger.h"
+
+// Passes checking how `PassManager` runs analyses for their consumers, see `tests/pass_manager`. They do nothing
+// unless `CompilationContext::run_test_passes` is set. The chain of required passes fixes the order:
+//   TestFuncCountAnalysis <- TestFirstConsumerPass <- TestInvalidatingPass <- TestSecondConsumerPass
+//   <- TestThirdConsumerPass
+// The analysis is computed for the first consumer, recomputed after the invalidating pass for the second consumer
+// and reused by the third one. If it fails, none of the consumers is run and its error is reported once per
+// computation.
+
+namespace daisy {
+
+namespace {
+std::size_t countDefinedFunctions(const ir::Node& node) {
+    std::size_t count = 0;
+    for (const auto& child : node) {
+        if (const auto* func = util::cast<const ir::FuncDefNode*>(&child); func && func->isDefined()) { ++count; }
+        count += countDefinedFunctions(child);
+    }
+    return count;
+}
+}  // namespace
+
+struct TestFuncCountResult : AnalysisResult {
+    explicit TestFuncCountResult(std::size_t n) : func_count(n) {}
+    std::size_t func_count;
+};
+
+class TestFuncCountAnalysis : public Pass {
+ public:
+    std::string_view getName() const override { return "TestFuncCountAnalysis"; }
+    bool isAnalysis() const override { return true; }
+    void getAnalysisUsage(AnalysisUsage& usage) const override { usage.addRequired("DaisyParserPass"); }
+    void configure() override {}
+    PassResult run(CompilationContext& ctx) override {
+        if (!ctx.run_test_passes) { return PassResult::kSuccess; }
+        const std::size_t func_count = ctx.ir_root ? countDefinedFunctions(*ctx.ir_root) : 0;
+        if (func_count == 0) {
+            logger::error(ctx.file_name).println("{}: no defined functions", getName());
+            ++ctx.error_count;
+            return PassResult::kError;
+        }
+        logger::info(ctx.file_name).println("{}: {} defined functions", getName(), func_count);
+        ctx.setAnalysisResult(getName(), std::make_unique<TestFuncCountResult>(func_count));
+        return PassResult::kSuccess;
+    }
+    void cleanup() override {}
+};
+
+// Consumes the analysis and preserves it
+class TestConsumerPass : public Pass {
+ public:
+    void getAnalysisUsage(AnalysisUsage& usage) const override {
+        usage.addRequired("TestFuncCountAnalysis").addPreserved("TestFuncCountAnalysis");
+        if (!previous_pass_.empty()) { usage.addRequired(previous_pass_); }
+    }
+    void configure() override {}
+    PassResult run(CompilationContext& ctx) override {
+        if (!ctx.run_test_passes) { return PassResult::kSuccess; }
+        const auto* result = ctx.getAnalysisResult<TestFuncCountResult>("TestFuncCountAnalysis");
+        logger::info(ctx.file_name).println("{}: {} defined functions", getName(), result->func_count);
+        return PassResult::kSuccess;
+    }
+    void cleanup() override {}
+
+ protected:
+    explicit TestConsumerPass(std::string_view previous_pass) : previous_pass_(previous_pass) {}
+
+ private:
+    std::string_view previous_pass_;
+};
+
+class TestFirstConsumerPass : public TestConsumerPass {
+ public:
+    TestFirstConsumerPass() : TestConsumerPass({}) {}
+    std::string_view getName() const override { return "TestFirstConsumerPass"; }
+};
+
+// Preserves nothing, so the analysis is recomputed for the next consumer
+class TestInvalidatingPass : public Pass {
+ public:
+    std::string_view getName() const override { return "TestInvalidatingPass"; }
+    void getAnalysisUsage(AnalysisUsage& usage) const override { usage.addRequired("TestFirstConsumerPass"); }
+    void configure() override {}
+    PassResult run(CompilationContext& ctx) override {
+        if (ctx.run_test_passes) { logger::info(ctx.file_name).println("{}: invalidating analyses", getName()); }
+        return PassResult::kSuccess;
+    }
+    void cleanup() override {}
+};
+
+class TestSecondConsumerPass : public TestConsumerPass {
+ public:
+    TestSecondConsumerPass() : TestConsumerPass("TestInvalidatingPass") {}
+    std::string_view getName() const override { return "TestSecondConsumerPass"; }
+};
+
+class TestThirdConsumerPass : public TestConsumerPass {
+ public:
+    TestThirdConsumerPass() : TestConsumerPass("TestSecondConsumerPass") {}
+    std::string_view getName() const override { return "TestThirdConsumerPass"; }
+};
+
+DAISY_ADD_PASS(TestFuncCountAnalysis);
+DAISY_ADD_PASS(TestFirstConsumerPass);
+DAISY_ADD_PASS(TestInvalidatingPass);
+DAISY_ADD_PASS(TestSecondConsumerPass);
+DAISY_ADD_PASS(TestThirdConsumerPass);
+
+}  // namespace daisy
@@ -0,0 +1,26 @@
+#include "ctx/ctx.h"
+#include "ir/nodes/func_def_node.h"
+#include "logger.h"
+
+// Reports each function `FunctionPass` visits, see `tests/pass_manager`. Messages of concurrently processed functions
+// must be printed in function order. Does nothing unless `CompilationContext::run_test_passes` is set.
+
+namespace daisy {
+
+class TestFunctionPass : public FunctionPass {
+ public:
+    std::string_view getName() const override { return "TestFunctionPass"; }
+    // Note: runs after the analysis test passes to keep the order of messages fixed
+    void getAnalysisUsage(AnalysisUsage& usage) const override { usage.addRequired("TestThirdConsumerPass"); }
+    void configure() override {}
+    PassResult runOnFunction(CompilationContext& ctx, ir::FuncDefNode& func) override {
+        if (ctx.run_test_passes) {
+            logger::info(ctx.file_name).println("{}: function `{}`", getName(), func.getProtoString());
+        }
+        return PassResult::kSuccess;
+    }
+};
+
+DAISY_ADD_PASS(TestFunctionPass);
+
+}  // namespace daisy
@@ -95,15 +95,20 @@ int main(int argc, char** argv) {
                           std::back_inserter(sout));
                 if1.close();
                 unsigned errs = 0, warns = 0;
-                if (auto status_pos = sout.rfind("errors"); status_pos != std::string::npos) {
-                    std::istringstream(sout.substr(status_pos + 6)) >> errs;
+                if (sout.rfind("errors") == std::string::npos && sout.find(": fatal error: ") != std::string::npos) {
+                    // Note: a fatal error in the command line stops the compiler before any file is compiled
+                    errs = 1;
                 } else {
-                    throw std::runtime_error("invalid compiler output");
-                }
-                if (auto status_pos = sout.rfind("warnings"); status_pos != std::string::npos) {
-                    std::istringstream(sout.substr(status_pos + 8)) >> warns;
-                } else {
-                    throw std::runtime_error("invalid compiler output");
+                    if (auto status_pos = sout.rfind("errors"); status_pos != std::string::npos) {
+                        std::istringstream(sout.substr(status_pos + 6)) >> errs;
+                    } else {
+                        throw std::runtime_error("invalid compiler output");
+                    }
+                    if (auto status_pos = sout.rfind("warnings"); status_pos != std::string::npos) {
+                        std::istringstream(sout.substr(status_pos + 8)) >> warns;
+                    } else {
+                        throw std::runtime_error("invalid compiler output");
+                    }
                 }
                 if ((!must_fail && (result != 0 || errs != 0)) || (must_fail && (result == 0 || errs == 0))) {
                     throw std::runtime_error("inconsistent compilation result");
@@ -128,6 +133,41 @@ int main(int argc, char** argv) {
                     std::cout << path << ": UPDATED!" << std::endl;
                 }
                 std::filesystem::remove(path + ".out");
+
+                // Dependency file is written if the test options include `-MD`
+                const std::string dep_path = std::filesystem::path(path).replace_extension(".d").string();
+                if (std::filesystem::exists(dep_path)) {
+                    std::ifstream if3(dep_path);
+                    if (!if3) { throw std::runtime_error("cannot open file `" + dep_path + "` for reading"); }
+                    std::string sdep;
+                    std::copy(std::istreambuf_iterator<char>{if3}, std::istreambuf_iterator<char>{},
+                              std::back_inserter(sdep));
+                    if3.close();
+                    std::filesystem::remove(dep_path);
+                    // Note: dependencies are absolute paths, so the tests directory is replaced with `.`
+                    const std::string tests_dir = std::filesystem::current_path().generic_string();
+                    for (auto pos = sdep.find(tests_dir); pos != std::string::npos;
+                         pos = sdep.find(tests_dir, pos + 1)) {
+                        sdep.replace(pos, tests_dir.size(), ".");
+                    }
+                    if (!update) {
+                        std::ifstream if4(dep_path + ".expected");
+                        if (!if4) {
+                            throw std::runtime_error("cannot open file `" + dep_path + ".expected" + "` for reading");
+                        }
+                        if (!std::equal(sdep.begin(), sdep.end(), std::istreambuf_iterator<char>{if4},
+                                        std::istreambuf_iterator<char>{})) {
+                            throw std::runtime_error("diffs with expected dependency file");
+                        }
+                    } else {
+                        std::ofstream of4(dep_path + ".expected");
+                        if (!of4) {
+                            throw std::runtime_error("cannot open file `" + dep_path + ".expected" + "` for writing");
+                        }
+                        std::copy(sdep.begin(), sdep.end(), std::ostreambuf_iterator<char>{of4});
+                    }
+                }
+
                 ++passed_test_count;
             } catch (const std::exception& ex) {
                 std::cout << path << ": \033[0;31m" << ex.what() << "\033[0m" << std::endl;